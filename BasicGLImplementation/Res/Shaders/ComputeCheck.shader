@@ -0,0 +1,22 @@
+#shader compute
+#version 430 core
+
+// Not a multiple of the item count the check dispatches, so the last group has invocations to skip
+layout(local_size_x = 64) in;
+
+layout(std430) buffer Values
+{
+	uint values[];
+};
+
+uniform int u_Count;
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	if (index >= uint(u_Count))
+		return;
+
+	values[index] = index * 2u + 1u;
+};
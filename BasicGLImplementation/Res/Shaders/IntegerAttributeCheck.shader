@@ -0,0 +1,28 @@
+#shader vertex
+#version 330 core
+
+// Fed with GL_INT data, only arrives intact if it is set up with glVertexAttribIPointer
+layout(location = 0) in ivec2 a_Value;
+
+flat out int v_Match;
+
+void main()
+{
+	// One triangle covering the whole target, whatever its size
+	vec2 positions[3] = vec2[3](vec2(-1.0, -1.0), vec2(3.0, -1.0), vec2(-1.0, 3.0));
+	gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+
+	v_Match = a_Value == ivec2(123456, -7) ? 1 : 0;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 colour;
+
+flat in int v_Match;
+
+void main()
+{
+	colour = v_Match == 1 ? vec4(0.0, 1.0, 0.0, 1.0) : vec4(1.0, 0.0, 0.0, 1.0);
+};
@@ -0,0 +1,53 @@
+#include "Arena.h"
+
+#include <algorithm>
+
+Arena::Arena(size_t blockSize)
+	: m_iCurrentBlock(0), m_iOffset(0), m_iBlockSize(blockSize)
+{
+}
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	while (m_iCurrentBlock < m_vBlocks.size())
+	{
+		block& current = m_vBlocks[m_iCurrentBlock];
+
+		// Align the address rather than the offset, block memory is only aligned for max_align_t
+		size_t address = (size_t)current.memory.get() + m_iOffset;
+		size_t padding = (alignment - address % alignment) % alignment;
+
+		if (m_iOffset + padding + size <= current.size)
+		{
+			m_iOffset += padding + size;
+			return current.memory.get() + m_iOffset - size;
+		}
+
+		// Move on to the next kept block (or a new one), the rest of this one is wasted until the next Reset
+		m_iCurrentBlock++;
+		m_iOffset = 0;
+	}
+
+	// Oversized allocations get a block of their own
+	size_t blockSize = std::max(m_iBlockSize, size + alignment);
+
+	m_vBlocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize });
+
+	return Allocate(size, alignment);
+}
+
+void Arena::Reset()
+{
+	m_iCurrentBlock = 0;
+	m_iOffset = 0;
+}
+
+size_t Arena::GetUsed() const
+{
+	size_t used = m_iOffset;
+
+	for (size_t i = 0; i < m_iCurrentBlock && i < m_vBlocks.size(); i++)
+		used += m_vBlocks[i].size;
+
+	return used;
+}
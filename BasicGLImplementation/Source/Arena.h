@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for short lived data, eg a frame's worth of recorded commands.
+// Memory comes from large blocks that are kept when the arena is reset, so once it has grown to its working size
+// allocating is just moving a pointer. Nothing is ever freed individually and no destructors are run.
+// Not thread safe, each thread records into its own arena.
+class Arena
+{
+private:
+
+	struct block
+	{
+		std::unique_ptr<unsigned char[]>	memory;
+		size_t								size;
+	};
+
+	std::vector<block> m_vBlocks;
+
+	// Block being allocated from and how far into it the next allocation starts
+	size_t m_iCurrentBlock;
+	size_t m_iOffset;
+
+	size_t m_iBlockSize;
+
+public:
+
+	Arena(size_t blockSize = 64 * 1024);
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// Construct a T in the arena, T must be trivially destructible since it is never destroyed
+	template<typename T, typename... Args>
+	T* New(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+
+		return new (Allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+	}
+
+	// Forget every allocation but keep the blocks for reuse
+	void Reset();
+
+	// Bytes used since the last Reset, counting the unused ends of blocks that were full
+	size_t GetUsed() const;
+};
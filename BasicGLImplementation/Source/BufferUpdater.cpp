@@ -0,0 +1,127 @@
+#include "BufferUpdater.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+BufferUpdater::BufferUpdater(unsigned int target, const void* data, unsigned int size)
+    : m_iSize(size), m_iBytesUploaded(size), m_iUploadCalls(1), m_iOrphans(0)
+{
+    GLCall(glBufferData(target, size, data, GL_STATIC_DRAW));
+}
+
+void BufferUpdater::Replace(unsigned int bufferId, const void* data, unsigned int size)
+{
+    m_iSize = size;
+    m_vDirty.clear();
+
+    // Only kept in step if UpdateRange has already needed it
+    if (!m_vShadow.empty())
+    {
+        m_vShadow.assign(size, 0);
+
+        if (data)
+            std::memcpy(m_vShadow.data(), data, size);
+    }
+
+    // Buffers that get updated aren't static any more, and glBufferData orphans the old storage
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId));
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_DYNAMIC_DRAW));
+
+    m_iBytesUploaded += size;
+    m_iUploadCalls++;
+    m_iOrphans++;
+}
+
+void BufferUpdater::Write(unsigned int bufferId, const void* data, unsigned int size, unsigned int offset)
+{
+    ASSERT(offset + size <= m_iSize);
+
+    if (size == 0)
+        return;
+
+    // A dirty range overlapping this one uploads the copy later, which has to hold the new bytes too
+    if (!m_vShadow.empty())
+        std::memcpy(m_vShadow.data() + offset, data, size);
+
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId));
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+
+    m_iBytesUploaded += size;
+    m_iUploadCalls++;
+}
+
+void BufferUpdater::UpdateRange(unsigned int bufferId, const void* data, unsigned int size, unsigned int offset)
+{
+    ASSERT(offset + size <= m_iSize);
+
+    if (size == 0)
+        return;
+
+    // Read back once rather than keeping a copy of every buffer from the start, this waits for the GPU the one time
+    if (m_vShadow.empty())
+    {
+        m_vShadow.resize(m_iSize);
+
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId));
+        GLCall(glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0, m_iSize, m_vShadow.data()));
+    }
+
+    std::memcpy(m_vShadow.data() + offset, data, size);
+    m_vDirty.push_back({ offset, offset + size });
+}
+
+void BufferUpdater::Flush(unsigned int bufferId)
+{
+    if (m_vDirty.empty())
+        return;
+
+    // The CPU copy already holds the latest bytes so overlapping edits can be merged in any order
+    std::sort(m_vDirty.begin(), m_vDirty.end());
+
+    unsigned int merged = 0;
+
+    for (unsigned int i = 1; i < m_vDirty.size(); i++)
+    {
+        if (m_vDirty[i].first <= m_vDirty[merged].second + MergeGap)
+            m_vDirty[merged].second = std::max(m_vDirty[merged].second, m_vDirty[i].second);
+        else
+            m_vDirty[++merged] = m_vDirty[i];
+    }
+
+    m_vDirty.resize(merged + 1);
+
+    unsigned int dirtyBytes = 0;
+
+    for (const auto& range : m_vDirty)
+        dirtyBytes += range.second - range.first;
+
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId));
+
+    unsigned int size = m_iSize;
+
+    if (dirtyBytes >= size * OrphanFraction)
+    {
+        // Fresh storage with the new contents in one call, draws queued against the old storage keep it until they finish
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, m_vShadow.data(), GL_DYNAMIC_DRAW));
+
+        m_iBytesUploaded += size;
+        m_iUploadCalls++;
+        m_iOrphans++;
+    }
+    else
+    {
+        for (const auto& range : m_vDirty)
+        {
+            GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, range.first, range.second - range.first, m_vShadow.data() + range.first));
+        }
+
+        m_iBytesUploaded += dirtyBytes;
+        m_iUploadCalls += (unsigned int)m_vDirty.size();
+    }
+
+    m_vDirty.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+// Collects the ranges of a buffer changed since the last Flush, so many small edits in a frame reach the driver as a
+// few glBufferSubData calls. Used by VertexBuffer and IndexBuffer.
+// Merging ranges and orphaning need the whole contents on the CPU, so a copy is kept once UpdateRange is first used.
+// Buffers that are never edited that way (most of them) don't pay for one.
+// Uploads go through GL_COPY_WRITE_BUFFER so they never disturb the vertex array or element buffer bindings.
+class BufferUpdater
+{
+public:
+
+	// Dirty ranges closer than this are uploaded as one, re-sending a few clean bytes is cheaper than another call
+	static constexpr unsigned int MergeGap = 256;
+
+	// Once at least this much of the buffer is dirty the whole buffer is orphaned and uploaded again, which lets the
+	// driver hand out fresh storage instead of waiting for draws still using the old contents
+	static constexpr float OrphanFraction = 0.5f;
+
+private:
+
+	unsigned int m_iSize;
+
+	// CPU copy of the contents, empty until the first UpdateRange
+	std::vector<char> m_vShadow;
+
+	// [begin, end) byte ranges written since the last Flush, in the order they were written
+	std::vector<std::pair<unsigned int, unsigned int>> m_vDirty;
+
+	unsigned long long m_iBytesUploaded;
+	unsigned int m_iUploadCalls;
+	unsigned int m_iOrphans;
+
+public:
+
+	// Creates the buffer's storage, which must be bound to target
+	BufferUpdater(unsigned int target, const void* data, unsigned int size);
+
+	// Replace the whole contents now, the size may change. Anything still dirty is dropped.
+	void Replace(unsigned int bufferId, const void* data, unsigned int size);
+
+	// Write the range now, the same as SetData on the other buffer types
+	void Write(unsigned int bufferId, const void* data, unsigned int size, unsigned int offset);
+
+	// Copy into the CPU copy and remember the range, nothing is sent to GL until Flush.
+	// The first call reads the contents back from GL to start the copy.
+	void UpdateRange(unsigned int bufferId, const void* data, unsigned int size, unsigned int offset);
+
+	// Upload the coalesced dirty ranges, or the whole buffer if enough of it is dirty
+	void Flush(unsigned int bufferId);
+
+	inline bool IsDirty() const { return !m_vDirty.empty(); }
+	inline unsigned int GetSize() const { return m_iSize; }
+
+	inline unsigned long long GetBytesUploaded() const { return m_iBytesUploaded; }
+	inline unsigned int GetUploadCalls() const { return m_iUploadCalls; }
+	inline unsigned int GetOrphans() const { return m_iOrphans; }
+};
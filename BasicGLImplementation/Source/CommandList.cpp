@@ -0,0 +1,109 @@
+#include "CommandList.h"
+
+#include "Renderer.h"
+#include "Shader.h"
+
+CommandList::CommandList()
+	: m_pFirst(nullptr), m_pLast(nullptr), m_iCount(0)
+{
+}
+
+void CommandList::Append(command* newCommand)
+{
+	newCommand->next = nullptr;
+
+	if (m_pLast)
+		m_pLast->next = newCommand;
+	else
+		m_pFirst = newCommand;
+
+	m_pLast = newCommand;
+	m_iCount++;
+}
+
+void CommandList::Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, int baseVertex)
+{
+	drawCommand* draw = m_Arena.New<drawCommand>();
+
+	draw->vertexArray = &vertexArray;
+	draw->indexBuffer = &indexBuffer;
+	draw->shader = &shader;
+	draw->baseVertex = baseVertex;
+
+	draw->header.type = commandType::Draw;
+	Append(&draw->header);
+}
+
+uniformValue* CommandList::AddUniform(Shader& shader, UniformId uniform)
+{
+	// UniformId has no default constructor so the command is built in place, the setter fills in the value
+	uniformCommand* update = new (m_Arena.Allocate(sizeof(uniformCommand), alignof(uniformCommand))) uniformCommand{ {}, &shader, { uniform, uniformValue::valueType::Float1, {}, 0 } };
+
+	update->header.type = commandType::Uniform;
+	Append(&update->header);
+
+	return &update->value;
+}
+
+void CommandList::SetUniform1f(Shader& shader, UniformId uniform, float v)
+{
+	AddUniform(shader, uniform)->Set1f(v);
+}
+
+void CommandList::SetUniform4f(Shader& shader, UniformId uniform, float v1, float v2, float v3, float v4)
+{
+	AddUniform(shader, uniform)->Set4f(v1, v2, v3, v4);
+}
+
+void CommandList::SetUniform1i(Shader& shader, UniformId uniform, int v)
+{
+	AddUniform(shader, uniform)->Set1i(v);
+}
+
+void CommandList::SetUniformMat4f(Shader& shader, UniformId uniform, const float* matrix)
+{
+	AddUniform(shader, uniform)->SetMat4f(matrix);
+}
+
+void CommandList::Execute(Renderer& renderer) const
+{
+	for (const command* current = m_pFirst; current; current = current->next)
+	{
+		switch (current->type)
+		{
+		case commandType::Draw:
+		{
+			const drawCommand* draw = (const drawCommand*)current;
+
+			renderer.Draw(*draw->vertexArray, *draw->indexBuffer, *draw->shader, draw->baseVertex);
+			break;
+		}
+		case commandType::Uniform:
+		{
+			const uniformCommand* update = (const uniformCommand*)current;
+
+			// The setters need the program bound, the state cache skips this if it already is
+			update->shader->Bind();
+
+			update->value.Apply(*update->shader);
+			break;
+		}
+		case commandType::BufferUpdate:
+		{
+			const bufferUpdateCommand* update = (const bufferUpdateCommand*)current;
+
+			update->apply(update->buffer, update->data, update->size, update->offset);
+			break;
+		}
+		}
+	}
+}
+
+void CommandList::Reset()
+{
+	m_Arena.Reset();
+
+	m_pFirst = nullptr;
+	m_pLast = nullptr;
+	m_iCount = 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstring>
+
+#include "Arena.h"
+#include "UniformCache.h"
+#include "UniformValues.h"
+
+class Renderer;
+class Shader;
+class VertexArray;
+class IndexBuffer;
+
+// Draws, uniform updates and buffer updates recorded without touching GL, so any thread can build one.
+// Commands and the data they carry are allocated from the list's arena. The GL thread then calls Execute,
+// which replays the commands in the order they were recorded. Everything referenced has to stay alive until
+// Execute has run, and a list mustn't be recorded into while it is being executed.
+class CommandList
+{
+private:
+
+	enum class commandType : unsigned char
+	{
+		Draw,
+		Uniform,
+		BufferUpdate
+	};
+
+	struct command
+	{
+		commandType	type;
+		command*	next;
+	};
+
+	struct drawCommand
+	{
+		command				header;
+		const VertexArray*	vertexArray;
+		const IndexBuffer*	indexBuffer;
+		Shader*				shader;
+		int					baseVertex;
+	};
+
+	struct uniformCommand
+	{
+		command			header;
+		Shader*			shader;
+		uniformValue	value;
+	};
+
+	// Buffer classes differ but all have SetData(data, size, offset), apply calls it on the right type
+	struct bufferUpdateCommand
+	{
+		command			header;
+		void*			buffer;
+		void			(*apply)(void* buffer, const void* data, unsigned int size, unsigned int offset);
+		const void*		data;
+		unsigned int	size;
+		unsigned int	offset;
+	};
+
+	Arena m_Arena;
+
+	command* m_pFirst;
+	command* m_pLast;
+
+	unsigned int m_iCount;
+
+	void Append(command* newCommand);
+
+	uniformValue* AddUniform(Shader& shader, UniformId uniform);
+
+public:
+
+	CommandList();
+
+	CommandList(const CommandList&) = delete;
+	CommandList& operator=(const CommandList&) = delete;
+
+	// Same as Renderer::Draw when replayed
+	void Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, int baseVertex = 0);
+
+	// Bind the shader and set the uniform when replayed, so they apply to the draws recorded after them
+	void SetUniform1f(Shader& shader, UniformId uniform, float v);
+	void SetUniform4f(Shader& shader, UniformId uniform, float v1, float v2, float v3, float v4);
+	void SetUniform1i(Shader& shader, UniformId uniform, int v);
+	void SetUniformMat4f(Shader& shader, UniformId uniform, const float* matrix);
+
+	// Copy the data now and upload it with buffer.SetData(data, size, offset) when replayed.
+	// Works with any buffer type that has that SetData, eg UniformBuffer, ShaderStorageBuffer, VertexBuffer and IndexBuffer.
+	template<typename Buffer>
+	void UpdateBuffer(Buffer& buffer, const void* data, unsigned int size, unsigned int offset = 0)
+	{
+		void* copy = m_Arena.Allocate(size);
+		std::memcpy(copy, data, size);
+
+		bufferUpdateCommand* update = m_Arena.New<bufferUpdateCommand>();
+
+		update->buffer = &buffer;
+		update->apply = [](void* target, const void* source, unsigned int sourceSize, unsigned int targetOffset)
+		{
+			((Buffer*)target)->SetData(source, sourceSize, targetOffset);
+		};
+		update->data = copy;
+		update->size = size;
+		update->offset = offset;
+
+		update->header.type = commandType::BufferUpdate;
+		Append(&update->header);
+	}
+
+	// GL thread only, replays every command in recording order
+	void Execute(Renderer& renderer) const;
+
+	// Drop every command and reuse the memory, for recording the next frame
+	void Reset();
+
+	inline unsigned int GetCommandCount() const { return m_iCount; }
+	inline size_t GetMemoryUsed() const { return m_Arena.GetUsed(); }
+};
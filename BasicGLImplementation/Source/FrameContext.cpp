@@ -0,0 +1,88 @@
+#include "FrameContext.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+FrameContext::FrameContext(unsigned int framesInFlight)
+	: m_iFramesInFlight(framesInFlight), m_Fences{}, m_iFrameNumber(0), m_iSlot(0), m_bInFrame(false),
+	  m_bSupported(GLEW_VERSION_3_2 || GLEW_ARB_sync), m_fLastWaitMs(0.0), m_fTotalWaitMs(0.0), m_iStalls(0)
+{
+	if (m_iFramesInFlight == 0 || m_iFramesInFlight > MaxFramesInFlight)
+	{
+		std::cout << "Can't keep " << framesInFlight << " frames in flight, using " << MaxFramesInFlight << std::endl;
+		m_iFramesInFlight = MaxFramesInFlight;
+	}
+
+	if (!m_bSupported)
+		std::cout << "Sync objects aren't supported, frames in flight won't be waited on" << std::endl;
+}
+
+FrameContext::~FrameContext()
+{
+	for (void* fence : m_Fences)
+	{
+		if (fence)
+		{
+			GLCall(glDeleteSync((GLsync)fence));
+		}
+	}
+}
+
+void FrameContext::BeginFrame()
+{
+	m_iSlot = (unsigned int)(m_iFrameNumber % m_iFramesInFlight);
+	m_bInFrame = true;
+	m_fLastWaitMs = 0.0;
+
+	GLsync fence = (GLsync)m_Fences[m_iSlot];
+
+	if (!fence)
+		return;
+
+	// Polling first avoids timing anything in the normal case where the GPU finished that frame long ago
+	GLCall(GLenum result = glClientWaitSync(fence, 0, 0));
+
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		auto waitStart = std::chrono::steady_clock::now();
+
+		// Flush in case the fence itself hasn't reached the GPU yet, otherwise the wait could never end
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+		do
+		{
+			GLCall(result = glClientWaitSync(fence, flags, 1000000)); // 1ms, in nanoseconds
+			flags = 0;
+		}
+		while (result == GL_TIMEOUT_EXPIRED);
+
+		m_fLastWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+		m_fTotalWaitMs += m_fLastWaitMs;
+		m_iStalls++;
+	}
+
+	if (result == GL_WAIT_FAILED)
+		std::cout << "Waiting for frame " << m_iFrameNumber - m_iFramesInFlight << " failed" << std::endl;
+
+	GLCall(glDeleteSync(fence));
+	m_Fences[m_iSlot] = nullptr;
+}
+
+void FrameContext::EndFrame()
+{
+	if (!m_bInFrame)
+		return;
+
+	if (m_bSupported)
+	{
+		GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		m_Fences[m_iSlot] = fence;
+	}
+
+	m_bInFrame = false;
+	m_iFrameNumber++;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// Lets the CPU run up to N frames ahead of the GPU without ever touching data the GPU may still be reading.
+// Per-frame resources (streaming buffer regions etc) are split into one slot per frame in flight. EndFrame puts a
+// fence in the command stream after the frame, and BeginFrame waits on the fence of the slot about to be reused,
+// which is the frame from N frames ago, so the wait is normally already satisfied and costs nothing.
+// The time spent actually waiting is measured, a steady non-zero wait means the GPU is the bottleneck.
+class FrameContext
+{
+public:
+
+	static constexpr unsigned int MaxFramesInFlight = 4;
+
+private:
+
+	unsigned int m_iFramesInFlight;
+
+	// GLsync objects, kept as void* so GL headers aren't needed here. nullptr when the slot has no pending fence.
+	void* m_Fences[MaxFramesInFlight];
+
+	unsigned long long m_iFrameNumber;
+	unsigned int m_iSlot;
+
+	bool m_bInFrame;
+	bool m_bSupported;
+
+	double m_fLastWaitMs;
+	double m_fTotalWaitMs;
+	unsigned int m_iStalls;
+
+public:
+
+	// Must be constructed after the GL context has been created. Without sync objects (GL 3.2 / ARB_sync)
+	// frames are never waited on, which is only safe for resources that aren't reused across frames.
+	FrameContext(unsigned int framesInFlight = 3);
+	~FrameContext();
+
+	FrameContext(const FrameContext&) = delete;
+	FrameContext& operator=(const FrameContext&) = delete;
+
+	// Wait until the GPU has finished with the slot this frame is going to use
+	void BeginFrame();
+
+	// Fence everything submitted this frame
+	void EndFrame();
+
+	// Between BeginFrame and EndFrame, the only time the frame slot's resources are safe to write
+	inline bool IsInFrame() const { return m_bInFrame; }
+
+	// The slot per-frame resources should use this frame, 0 to GetFramesInFlight() - 1
+	inline unsigned int GetFrameSlot() const { return m_iSlot; }
+	inline unsigned int GetFramesInFlight() const { return m_iFramesInFlight; }
+	inline unsigned long long GetFrameNumber() const { return m_iFrameNumber; }
+
+	// CPU time spent blocked in the last BeginFrame and in total
+	inline double GetLastWaitMs() const { return m_fLastWaitMs; }
+	inline double GetTotalWaitMs() const { return m_fTotalWaitMs; }
+
+	// Frames that had to wait at all
+	inline unsigned int GetStalls() const { return m_iStalls; }
+};
@@ -0,0 +1,217 @@
+#include "GLDebugLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+GLDebugLog::GLDebugLog(int messagesPerSecond)
+	: m_EnqueuePos(0), m_DequeuePos(0), m_iBudget(messagesPerSecond), m_iMessagesPerSecond(messagesPerSecond),
+	  m_iRepeated(0), m_iRateLimited(0), m_iOverflowed(0), m_iLastRateLimited(0), m_iLastOverflowed(0), m_bRunning(true)
+{
+	for (unsigned int i = 0; i < RingSize; i++)
+		m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+
+	// 0 marks an empty key slot
+	for (unsigned int i = 0; i < KeyTableSize; i++)
+	{
+		m_SeenKeys[i].store(0, std::memory_order_relaxed);
+		m_Repeats[i].store(0, std::memory_order_relaxed);
+	}
+
+	m_Thread = std::thread(&GLDebugLog::Run, this);
+}
+
+GLDebugLog::~GLDebugLog()
+{
+	m_bRunning = false;
+	m_Thread.join();
+}
+
+unsigned int GLDebugLog::FindKey(unsigned long long key, bool claim)
+{
+	unsigned int index = (unsigned int)(key ^ (key >> 32)) & (KeyTableSize - 1);
+
+	// A short probe is enough, if the table is that full the message just isn't deduplicated
+	for (unsigned int probe = 0; probe < 16; probe++)
+	{
+		unsigned int slot = (index + probe) & (KeyTableSize - 1);
+
+		unsigned long long current = m_SeenKeys[slot].load(std::memory_order_relaxed);
+
+		if (current == 0)
+		{
+			if (!claim)
+				return KeyTableSize;
+
+			if (m_SeenKeys[slot].compare_exchange_strong(current, key, std::memory_order_relaxed))
+				return slot;
+		}
+
+		// Either already there or another thread claimed the slot for this key first
+		if (current == key)
+			return slot;
+	}
+
+	return KeyTableSize;
+}
+
+bool GLDebugLog::Push(unsigned long long key, std::string_view prefix, std::string_view message)
+{
+	// 0 marks an empty key slot
+	if (key == 0)
+		key = 1;
+
+	unsigned int seen = FindKey(key, false);
+
+	if (seen != KeyTableSize)
+	{
+		m_Repeats[seen].fetch_add(1, std::memory_order_relaxed);
+		m_iRepeated.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	if (m_iBudget.fetch_sub(1, std::memory_order_relaxed) <= 0)
+	{
+		m_iRateLimited.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Claim a slot, the position only moves on once the slot at it is free
+	unsigned int pos = m_EnqueuePos.load(std::memory_order_relaxed);
+	logSlot* slot = nullptr;
+
+	for (;;)
+	{
+		slot = &m_Slots[pos & (RingSize - 1)];
+
+		unsigned int sequence = slot->sequence.load(std::memory_order_acquire);
+		int difference = (int)(sequence - pos);
+
+		if (difference == 0)
+		{
+			if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			// The logger hasn't got to this slot yet, drop rather than wait
+			m_iOverflowed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			pos = m_EnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	size_t prefixLength = std::min(prefix.size(), (size_t)MaxMessageLength);
+	size_t messageLength = std::min(message.size(), MaxMessageLength - prefixLength);
+
+	std::memcpy(slot->text, prefix.data(), prefixLength);
+	std::memcpy(slot->text + prefixLength, message.data(), messageLength);
+
+	slot->key = key;
+	slot->length = (unsigned int)(prefixLength + messageLength);
+
+	// Publish the slot to the logger
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	// Only mark the key as printed once the message is actually queued, so one dropped over the budget or with the
+	// ring full is printed the next time it comes round rather than only ever counted as a repeat.
+	// Two threads pushing a new key at once may both get it queued, which is harmless.
+	FindKey(key, true);
+
+	return true;
+}
+
+unsigned int GLDebugLog::Drain(std::string& output)
+{
+	unsigned int drained = 0;
+
+	for (;;)
+	{
+		logSlot& slot = m_Slots[m_DequeuePos & (RingSize - 1)];
+
+		if (slot.sequence.load(std::memory_order_acquire) != m_DequeuePos + 1)
+			break;
+
+		output.append(slot.text, slot.length);
+		output += '\n';
+
+		m_FirstText.emplace(slot.key, std::string(slot.text, std::min(slot.length, SummaryLength)));
+
+		// Hand the slot back to the producers for the next time round the ring
+		slot.sequence.store(m_DequeuePos + RingSize, std::memory_order_release);
+		m_DequeuePos++;
+
+		drained++;
+	}
+
+	return drained;
+}
+
+void GLDebugLog::Summarise(std::string& output)
+{
+	for (unsigned int i = 0; i < KeyTableSize; i++)
+	{
+		unsigned int repeats = m_Repeats[i].exchange(0, std::memory_order_relaxed);
+
+		if (repeats == 0)
+			continue;
+
+		// The key is in the table so its message has been queued, and drained by now unless the ring is still behind
+		auto firstText = m_FirstText.find(m_SeenKeys[i].load(std::memory_order_relaxed));
+
+		output += "[OpenGL] repeated " + std::to_string(repeats) + " more time(s): ";
+		output += firstText != m_FirstText.end() ? firstText->second : "(message still queued)";
+		output += '\n';
+	}
+
+	unsigned int rateLimited = m_iRateLimited.load(std::memory_order_relaxed);
+	unsigned int overflowed = m_iOverflowed.load(std::memory_order_relaxed);
+
+	if (rateLimited != m_iLastRateLimited || overflowed != m_iLastOverflowed)
+		output += "[OpenGL] dropped " + std::to_string(rateLimited - m_iLastRateLimited) + " message(s) over the rate limit and " + std::to_string(overflowed - m_iLastOverflowed) + " with the log full\n";
+
+	m_iLastRateLimited = rateLimited;
+	m_iLastOverflowed = overflowed;
+}
+
+void GLDebugLog::Run()
+{
+	auto lastSummary = std::chrono::steady_clock::now();
+
+	std::string output;
+
+	for (;;)
+	{
+		// Read the flag before draining so nothing pushed before shutdown is missed
+		bool running = m_bRunning;
+
+		unsigned int drained = Drain(output);
+
+		auto now = std::chrono::steady_clock::now();
+
+		if (now - lastSummary >= std::chrono::seconds(1) || !running)
+		{
+			Summarise(output);
+
+			m_iBudget.store(m_iMessagesPerSecond, std::memory_order_relaxed);
+			lastSummary = now;
+		}
+
+		// One write and flush per batch instead of an std::endl per message
+		if (!output.empty())
+		{
+			std::cout << output << std::flush;
+			output.clear();
+		}
+
+		if (!running)
+			break;
+
+		if (drained == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
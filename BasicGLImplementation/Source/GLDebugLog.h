@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+// Asynchronous log for GL debug output and errors.
+// Messages are pushed into a fixed size lock-free ring from any thread (the KHR_debug callback may be called from
+// driver threads) and printed by a logger thread, so the render thread never waits on std::cout.
+// Each message key is printed once, repeats are only counted and summarised once a second, and a per second budget
+// caps how much gets queued at all, so an error storm turns into a few counters rather than a stalled frame.
+class GLDebugLog
+{
+public:
+
+	static constexpr unsigned int RingSize = 256;			// must be a power of two
+	static constexpr unsigned int MaxMessageLength = 512;	// longer messages are cut short
+	static constexpr unsigned int KeyTableSize = 1024;		// must be a power of two
+	static constexpr unsigned int SummaryLength = 120;		// how much of a message is repeated in its summary
+
+private:
+
+	struct logSlot
+	{
+		// Vyukov style sequence number: equal to the write position when free, position + 1 once written
+		std::atomic<unsigned int>	sequence;
+		unsigned long long			key;
+		unsigned int				length;
+		char						text[MaxMessageLength];
+	};
+
+	logSlot m_Slots[RingSize];
+
+	std::atomic<unsigned int> m_EnqueuePos;
+
+	// Only touched by the logger thread
+	unsigned int m_DequeuePos;
+
+	// Keys that have already been printed and how many times each has been repeated since the last summary.
+	// Open addressing, a key is never removed so a slot is claimed with a single compare exchange.
+	std::atomic<unsigned long long> m_SeenKeys[KeyTableSize];
+	std::atomic<unsigned int> m_Repeats[KeyTableSize];
+
+	// Messages that may still be queued this second, refilled by the logger thread
+	std::atomic<int> m_iBudget;
+	int m_iMessagesPerSecond;
+
+	std::atomic<unsigned int> m_iRepeated;
+	std::atomic<unsigned int> m_iRateLimited;
+	std::atomic<unsigned int> m_iOverflowed;
+
+	// Drop counts at the last summary, only touched by the logger thread
+	unsigned int m_iLastRateLimited;
+	unsigned int m_iLastOverflowed;
+
+	// The start of the first message printed for each key, so summaries say which message repeated.
+	// Only touched by the logger thread.
+	std::unordered_map<unsigned long long, std::string> m_FirstText;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_bRunning;
+
+	void Run();
+
+	// Logger thread, appends every queued message to output and returns how many there were
+	unsigned int Drain(std::string& output);
+
+	// Logger thread, appends the repeat and drop counts gathered since the last call
+	void Summarise(std::string& output);
+
+	// Index of the key in the key table, KeyTableSize if it isn't there. With claim set an empty slot is taken for it.
+	unsigned int FindKey(unsigned long long key, bool claim);
+
+public:
+
+	GLDebugLog(int messagesPerSecond = 20);
+
+	// Prints whatever is still queued before returning
+	~GLDebugLog();
+
+	// Queue a message, the text is prefix followed by message. Repeats are summarised by key so the key should be in the text. Never blocks, safe to call from any thread.
+	// Returns false if the message was dropped as a repeat, for being over budget or because the ring was full.
+	bool Push(unsigned long long key, std::string_view prefix, std::string_view message);
+
+	inline unsigned int GetRepeated() const { return m_iRepeated; }
+	inline unsigned int GetRateLimited() const { return m_iRateLimited; }
+	inline unsigned int GetOverflowed() const { return m_iOverflowed; }
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string_view>
+
+// 64 bit FNV-1a hash, pass the result of a previous call as the seed to hash several strings together
+constexpr unsigned long long HashBytes(std::string_view bytes, unsigned long long seed = 14695981039346656037ull)
+{
+	unsigned long long hash = seed;
+
+	for (char c : bytes)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
@@ -3,31 +3,63 @@
 #include "GL/glew.h"
 
 #include "Renderer.h"
+#include "StateCache.h"
 
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    : m_Count(count)
+// Generates the buffer id and binds it so the updater can create the storage
+static unsigned int CreateIndexBuffer()
 {
-
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
+    unsigned int bufferId;
+
     // Create an index buffer with the provided id (indexBuffer) and bind it
-    GLCall(glGenBuffers(1, &m_RendererId));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererId));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+    GLCall(glGenBuffers(1, &bufferId));
+    StateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferId);
+
+    return bufferId;
+}
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
+    : m_RendererId(CreateIndexBuffer()), m_Count(count), m_Type(GL_UNSIGNED_INT),
+      m_Updater(GL_ELEMENT_ARRAY_BUFFER, data, count * sizeof(unsigned int))
+{
 }
 
 IndexBuffer::~IndexBuffer()
 {
+    StateCache::OnBufferDeleted(m_RendererId);
     GLCall(glDeleteBuffers(1, &m_RendererId));
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererId));
+    // The element buffer binding belongs to the bound vertex array
+    StateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererId);
 }
 
 void IndexBuffer::UnBind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    StateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void IndexBuffer::Replace(const unsigned int* data, unsigned int count)
+{
+    m_Updater.Replace(m_RendererId, data, count * sizeof(unsigned int));
+    m_Count = count;
+}
+
+void IndexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    m_Updater.Write(m_RendererId, data, size, offset);
+}
+
+void IndexBuffer::UpdateRange(const unsigned int* data, unsigned int count, unsigned int firstIndex)
+{
+    m_Updater.UpdateRange(m_RendererId, data, count * sizeof(unsigned int), firstIndex * sizeof(unsigned int));
+}
+
+void IndexBuffer::Flush()
+{
+    m_Updater.Flush(m_RendererId);
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "BufferUpdater.h"
+
 class IndexBuffer
 {
 public:
@@ -9,10 +11,33 @@ public:
 	void Bind() const;
 	void UnBind() const;
 
-	inline unsigned int GetCount() { return m_Count; }
+	// Replace every index now, the count may change
+	void Replace(const unsigned int* data, unsigned int count);
+
+	// Write size bytes of indices at a byte offset now, inside the current count. Matches the other buffer types so
+	// CommandList::UpdateBuffer can record it.
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	// Change count indices starting at firstIndex, edits are coalesced and uploaded by the next Flush
+	void UpdateRange(const unsigned int* data, unsigned int count, unsigned int firstIndex);
+
+	// Upload the edits made with UpdateRange, call once they are done and before drawing
+	void Flush();
+
+	inline unsigned int GetCount() const { return m_Count; }
+
+	inline unsigned long long GetBytesUploaded() const { return m_Updater.GetBytesUploaded(); }
+	inline unsigned int GetUploadCalls() const { return m_Updater.GetUploadCalls(); }
+
+	// GL type of each index, eg GL_UNSIGNED_INT
+	inline unsigned int GetType() const { return m_Type; }
 
 private:
 
 	unsigned int m_RendererId;
 	unsigned int m_Count;
+	unsigned int m_Type;
+
+	// CPU copy of the indices and the ranges changed since the last Flush
+	BufferUpdater m_Updater;
 };
\ No newline at end of file
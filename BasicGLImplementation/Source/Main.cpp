@@ -6,13 +6,23 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <chrono>
+#include <memory>
 
 #include "Renderer.h"
+#include "GLDebugLog.h"
 
 #include "VertexBuffer.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderWatcher.h"
+#include "CommandList.h"
+#include "RenderThread.h"
+#include "SelfCheck.h"
 
 struct colourChangeValues
 {
@@ -43,14 +53,53 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         IncColour(colours.B);
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    // Per call glGetError checks are too slow to leave on in release builds, --gl-errors=off|frame|call|debug overrides this
+#ifdef NDEBUG
+    GLErrorMode errorMode = GLErrorMode::PerFrame;
+#else
+    GLErrorMode errorMode = GLErrorMode::PerCall;
+#endif
+
+    // --render-thread moves all GL work off the main thread, which then only handles input and records frames
+    bool useRenderThread = false;
+
+    // --self-check runs the offscreen checks in SelfCheck with a hidden window and exits, non zero if any failed
+    bool runSelfCheck = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg = argv[i];
+
+        if (arg.substr(0, 12) == "--gl-errors=" && !GLErrorCheck::ParseMode(arg.substr(12), errorMode))
+            std::cout << "Unknown GL error mode " << arg.substr(12) << ", expected off, frame, call or debug" << std::endl;
+
+        if (arg == "--render-thread")
+            useRenderThread = true;
+
+        if (arg == "--self-check")
+            runSelfCheck = true;
+    }
+
+    // GL errors and debug messages are printed by the log's own thread, declared first so it outlives every GL object
+    GLDebugLog debugLog;
+    GLErrorCheck::SetLog(&debugLog);
+
     /* Initialize the library */
     if (!glfwInit())
         return -1;
 
+    // Drivers only guarantee to produce KHR_debug output for debug contexts
+    if (errorMode == GLErrorMode::DebugCallback)
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+
+    // The checks draw offscreen so there's no need to show anything, which also lets them run without a desktop
+    if (runSelfCheck)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
 
@@ -77,6 +126,20 @@ int main(void)
         // ...
     }
 
+    GLErrorCheck::SetMode(errorMode);
+
+    if (runSelfCheck)
+    {
+        unsigned int failed = SelfCheck::RunAll();
+
+        GLErrorCheck::ReportCallSites();
+
+        glfwTerminate();
+
+        GLErrorCheck::SetLog(nullptr);
+        return failed == 0 ? 0 : 1;
+    }
+
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -124,38 +187,96 @@ int main(void)
 
     IndexBuffer indexBuffer(SimpleSquareIndices, 6);
 
-    Shader shader("Res/Shaders/BasicShader.shader");
-    shader.Bind();
+    // Reuse program binaries from previous runs instead of compiling every shader at startup
+    ProgramBinaryCache binaryCache("ShaderCache");
+    Shader::SetProgramBinaryCache(&binaryCache);
+
+    // Submit every program up front so the driver can compile them in parallel while the loop starts running
+    auto shaderStartTime = std::chrono::steady_clock::now();
+    bool shadersReported = false;
+
+    ShaderCompiler shaderCompiler;
+
+    Shader shader("Res/Shaders/BasicShader.shader", shaderCompiler);
 
-    shader.SetUniform4f("u_Colour", 0.0f, 1.0f, 0.0f, 1.0f);
+    // Reload the shader whenever its file is saved
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.Watch(shader);
 
     // Unbind all buffers/programs/attribs by passing 0
 
     vertexArray.Unbind();
     shader.Unbind();
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    vertexBuffer.UnBind();
+    indexBuffer.UnBind();
+
+    Renderer renderer;
+
+    // Done at the start of every frame on whichever thread owns the context
+    auto updateShaders = [&]()
+    {
+        // Finish off any programs the driver has completed since the last frame
+        if (!shadersReported && shaderCompiler.Poll() == 0)
+        {
+            auto shaderTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStartTime);
+
+            std::cout << "Shaders ready after " << shaderTime.count() << "ms, program binary cache hits: " << binaryCache.GetHits() << " misses: " << binaryCache.GetMisses() << std::endl;
+
+            shadersReported = true;
+        }
+
+        // Relink any shaders whose files changed, this is the only point in the frame programs get swapped
+        shaderWatcher.ApplyChanges();
+    };
+
+    // Takes the context away from this thread until it is destroyed
+    std::unique_ptr<RenderThread> renderThread;
+
+    if (useRenderThread)
+        renderThread = std::make_unique<RenderThread>(window, renderer, updateShaders);
 
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window))
     {
+        if (renderThread)
+        {
+            // Record the frame for the render thread, no GL calls are made here
+            if (CommandList* frame = renderThread->TryBeginFrame())
+            {
+                frame->SetUniform4f(shader, "u_Colour"_uniform, colours.R, colours.G, colours.B, 1.0f);
+                frame->Draw(vertexArray, indexBuffer, shader);
+
+                renderThread->EndFrame();
+
+                glfwPollEvents();
+            }
+            else
+            {
+                // The render thread is a full queue behind, keep handling input while it catches up
+                glfwWaitEventsTimeout(0.001);
+            }
+
+            continue;
+        }
+
+        // Wait for the GPU if it is still using this frame's slot from three frames ago, normally it is long done
+        renderer.BeginFrame();
+
         /* Render here */
-        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        renderer.Clear();
 
-        // Bind the shader program
-        shader.Bind();
+        updateShaders();
 
-        // Set the colour uniform using the initial RGB values
-        shader.SetUniform4f("u_Colour", colours.R, colours.G, colours.B, 1.0f);
-   
-        // Bind the vertex array object instead of having to bind the buffer and then add attrib
-        vertexArray.Bind();
+        // Queue the square with its colour (the _uniform literal is hashed at compile time), queued draws are sorted by
+        // state and drawn in EndFrame. Until the shader has finished compiling it draws with the fallback program.
+        renderer.Submit(vertexArray, indexBuffer, shader)
+            .SetUniform4f("u_Colour"_uniform, colours.R, colours.G, colours.B, 1.0f);
 
-        // Bind the index buffer
-        indexBuffer.Bind();
+        // Draw the queue, then collect draw calls, triangles and state changes for the frame, binds after the first frame are all skipped as redundant
+        renderer.EndFrame();
 
-        // Draw call which uses the index array instead of raw positions 
-        GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+        // Collect the frame's GL errors when they aren't checked call by call
+        GLErrorCheck::EndFrame();
 
         /* Swap front and back buffers */
         GLCall(glfwSwapBuffers(window));
@@ -164,7 +285,15 @@ int main(void)
         GLCall(glfwPollEvents());
     }
 
+    // Renders the frames still queued and hands the context back before anything GL is destroyed
+    renderThread.reset();
+
+    GLErrorCheck::ReportCallSites();
+
     glfwTerminate();
+
+    // Objects destroyed on the way out of main print straight to the console
+    GLErrorCheck::SetLog(nullptr);
     return 0;
 }
 
@@ -0,0 +1,181 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: m_pData(nullptr), m_iSize(0), m_hFile(nullptr), m_hMapping(nullptr), m_bOpen(false)
+{
+}
+
+MappedFile::MappedFile(const std::string& path)
+	: MappedFile()
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	m_hFile = file;
+	m_bOpen = true;
+
+	LARGE_INTEGER size;
+
+	// Windows can't map an empty file, treat it as open with no contents
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		return;
+
+	m_hMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!m_hMapping)
+	{
+		Close();
+		return;
+	}
+
+	m_pData = (const char*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!m_pData)
+	{
+		Close();
+		return;
+	}
+
+	m_iSize = (size_t)size.QuadPart;
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+
+	if (m_hFile)
+		CloseHandle(m_hFile);
+
+	m_pData = nullptr;
+	m_iSize = 0;
+	m_hFile = nullptr;
+	m_hMapping = nullptr;
+	m_bOpen = false;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_pData(other.m_pData), m_iSize(other.m_iSize), m_hFile(other.m_hFile), m_hMapping(other.m_hMapping), m_bOpen(other.m_bOpen)
+{
+	other.m_pData = nullptr;
+	other.m_iSize = 0;
+	other.m_hFile = nullptr;
+	other.m_hMapping = nullptr;
+	other.m_bOpen = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+
+		std::swap(m_pData, other.m_pData);
+		std::swap(m_iSize, other.m_iSize);
+		std::swap(m_hFile, other.m_hFile);
+		std::swap(m_hMapping, other.m_hMapping);
+		std::swap(m_bOpen, other.m_bOpen);
+	}
+
+	return *this;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: m_pData(nullptr), m_iSize(0), m_iFile(-1), m_bOpen(false)
+{
+}
+
+MappedFile::MappedFile(const std::string& path)
+	: MappedFile()
+{
+	m_iFile = open(path.c_str(), O_RDONLY);
+
+	if (m_iFile == -1)
+		return;
+
+	m_bOpen = true;
+
+	struct stat info;
+
+	// mmap can't map an empty file, treat it as open with no contents
+	if (fstat(m_iFile, &info) != 0 || info.st_size == 0)
+		return;
+
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_iFile, 0);
+
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return;
+	}
+
+	m_pData = (const char*)data;
+	m_iSize = (size_t)info.st_size;
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+		munmap((void*)m_pData, m_iSize);
+
+	if (m_iFile != -1)
+		close(m_iFile);
+
+	m_pData = nullptr;
+	m_iSize = 0;
+	m_iFile = -1;
+	m_bOpen = false;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_pData(other.m_pData), m_iSize(other.m_iSize), m_iFile(other.m_iFile), m_bOpen(other.m_bOpen)
+{
+	other.m_pData = nullptr;
+	other.m_iSize = 0;
+	other.m_iFile = -1;
+	other.m_bOpen = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+
+		std::swap(m_pData, other.m_pData);
+		std::swap(m_iSize, other.m_iSize);
+		std::swap(m_iFile, other.m_iFile);
+		std::swap(m_bOpen, other.m_bOpen);
+	}
+
+	return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
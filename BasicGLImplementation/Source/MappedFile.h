@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read only memory mapping of a whole file, the contents stay valid until the MappedFile is destroyed
+class MappedFile
+{
+private:
+
+	const char* m_pData;
+	size_t m_iSize;
+
+#ifdef _WIN32
+	void* m_hFile;
+	void* m_hMapping;
+#else
+	int m_iFile;
+#endif
+
+	bool m_bOpen;
+
+	void Close();
+
+public:
+
+	MappedFile();
+	MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline bool IsOpen() const { return m_bOpen; }
+	inline std::string_view GetContents() const { return std::string_view(m_pData, m_iSize); }
+};
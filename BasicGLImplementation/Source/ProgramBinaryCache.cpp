@@ -0,0 +1,161 @@
+#include "ProgramBinaryCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+#include "Hash.h"
+#include "ShaderSource.h"
+
+// Written at the start of every cache file so stale or foreign files are rejected before glProgramBinary sees them
+struct binaryCacheHeader
+{
+	unsigned int		magic;
+	unsigned int		binaryFormat;
+	unsigned long long	key;
+	unsigned long long	driverHash;
+	int					length;
+};
+
+static const unsigned int s_BinaryCacheMagic = 0x42504C47; // "GLPB"
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+	: m_Directory(directory), m_DriverHash(0), m_bSupported(false), m_iHits(0), m_iMisses(0)
+{
+	// Program binaries are core in 4.1, older drivers may still expose the extension
+	if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+		return;
+
+	// A driver can support the extension but offer no binary formats at all
+	int formatCount = 0;
+	GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+
+	if (formatCount == 0)
+		return;
+
+	m_vBinaryFormats.resize(formatCount);
+	GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_vBinaryFormats.data()));
+
+	// Any driver update changes at least one of these so old binaries are never handed to a new driver
+	const char* driverStrings[] = {
+		(const char*)glGetString(GL_VENDOR),
+		(const char*)glGetString(GL_RENDERER),
+		(const char*)glGetString(GL_VERSION)
+	};
+
+	m_DriverHash = HashBytes("");
+
+	for (const char* driverString : driverStrings)
+		m_DriverHash = HashBytes(driverString ? driverString : "", HashBytes("|", m_DriverHash));
+
+	std::error_code error;
+	std::filesystem::create_directories(m_Directory, error);
+
+	if (error)
+	{
+		std::cout << "Failed to create program binary cache directory " << m_Directory << ", message: " << error.message() << std::endl;
+		return;
+	}
+
+	m_bSupported = true;
+}
+
+unsigned long long ProgramBinaryCache::MakeKey(const shaderProgSource& source, const std::string& defines) const
+{
+	return HashShaderSource(source, HashBytes(defines, m_DriverHash));
+}
+
+std::string ProgramBinaryCache::GetEntryPath(unsigned long long key) const
+{
+	std::stringstream path;
+	path << m_Directory << '/' << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+
+	return path.str();
+}
+
+unsigned int ProgramBinaryCache::Load(unsigned long long key)
+{
+	if (!m_bSupported)
+		return 0;
+
+	std::ifstream file(GetEntryPath(key), std::ios::binary);
+
+	binaryCacheHeader header;
+
+	if (!file.read((char*)&header, sizeof(header))
+		|| header.magic != s_BinaryCacheMagic || header.key != key || header.driverHash != m_DriverHash || header.length <= 0)
+	{
+		m_iMisses++;
+		return 0;
+	}
+
+	// A format this driver doesn't offer is an INVALID_ENUM, which GLCall would treat as fatal
+	if (std::find(m_vBinaryFormats.begin(), m_vBinaryFormats.end(), (int)header.binaryFormat) == m_vBinaryFormats.end())
+	{
+		m_iMisses++;
+		return 0;
+	}
+
+	std::vector<char> binary(header.length);
+
+	if (!file.read(binary.data(), header.length))
+	{
+		m_iMisses++;
+		return 0;
+	}
+
+	unsigned int programId = glCreateProgram();
+
+	// Load the binary in place of attaching, compiling and linking shaders.
+	// Not in a GLCall, a corrupt entry is an expected miss rather than a bug, so any error is cleared and the
+	// link status decides.
+	glProgramBinary(programId, header.binaryFormat, binary.data(), header.length);
+
+	while (glGetError() != GL_NO_ERROR);
+
+	int linked;
+	GLCall(glGetProgramiv(programId, GL_LINK_STATUS, &linked));
+
+	// The driver is allowed to reject any binary, in which case the caller compiles from source
+	if (linked != GL_TRUE)
+	{
+		GLCall(glDeleteProgram(programId));
+
+		m_iMisses++;
+		return 0;
+	}
+
+	m_iHits++;
+	return programId;
+}
+
+void ProgramBinaryCache::Store(unsigned long long key, unsigned int programId)
+{
+	if (!m_bSupported)
+		return;
+
+	int length = 0;
+	GLCall(glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length));
+
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+
+	binaryCacheHeader header = { s_BinaryCacheMagic, 0, key, m_DriverHash, 0 };
+	GLCall(glGetProgramBinary(programId, length, &header.length, &header.binaryFormat, binary.data()));
+
+	std::ofstream file(GetEntryPath(key), std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), header.length);
+
+	if (!file)
+		std::cout << "Failed to write program binary cache entry " << GetEntryPath(key) << std::endl;
+}
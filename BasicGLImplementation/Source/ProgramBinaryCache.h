@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct shaderProgSource;
+
+// Stores linked programs on disk with glGetProgramBinary so later runs can skip compiling and linking.
+// Entries are keyed on the shader source and the vendor/renderer/version strings of the driver,
+// any entry the driver refuses to load is treated as a miss and the program is compiled as normal.
+class ProgramBinaryCache
+{
+private:
+
+	std::string m_Directory;
+
+	// Hash of the GL_VENDOR, GL_RENDERER and GL_VERSION strings
+	unsigned long long m_DriverHash;
+
+	// GL_PROGRAM_BINARY_FORMATS, entries in any other format are never handed to the driver
+	std::vector<int> m_vBinaryFormats;
+
+	bool m_bSupported;
+
+	unsigned int m_iHits;
+	unsigned int m_iMisses;
+
+	std::string GetEntryPath(unsigned long long key) const;
+
+public:
+
+	// Must be constructed after the GL context has been created
+	ProgramBinaryCache(const std::string& directory);
+
+	// Key for the given stage sources and injected #define lines on the current driver
+	unsigned long long MakeKey(const shaderProgSource& source, const std::string& defines) const;
+
+	// Returns a linked program if there is a usable entry for the key, otherwise 0
+	unsigned int Load(unsigned long long key);
+
+	// Write the binary of a successfully linked program to the cache
+	void Store(unsigned long long key, unsigned int programId);
+
+	inline bool IsSupported() const { return m_bSupported; }
+
+	inline unsigned int GetHits() const { return m_iHits; }
+	inline unsigned int GetMisses() const { return m_iMisses; }
+};
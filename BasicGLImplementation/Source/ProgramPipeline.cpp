@@ -0,0 +1,133 @@
+#include "ProgramPipeline.h"
+
+#include <iostream>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+#include "Hash.h"
+#include "StateCache.h"
+
+static unsigned int GetShaderStageBit(ShaderStage stage)
+{
+	switch (stage)
+	{
+	case ShaderStage::Vertex:			return GL_VERTEX_SHADER_BIT;
+	case ShaderStage::Fragment:			return GL_FRAGMENT_SHADER_BIT;
+	case ShaderStage::Geometry:			return GL_GEOMETRY_SHADER_BIT;
+	case ShaderStage::TessControl:		return GL_TESS_CONTROL_SHADER_BIT;
+	case ShaderStage::TessEvaluation:	return GL_TESS_EVALUATION_SHADER_BIT;
+	case ShaderStage::Compute:			return GL_COMPUTE_SHADER_BIT;
+	}
+
+	return 0;
+}
+
+bool ProgramPipeline::IsSupported()
+{
+	return GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+}
+
+ProgramPipeline::ProgramPipeline(std::initializer_list<const StageProgram*> stages)
+	: m_RendererID(0), m_bValid(false)
+{
+	GLCall(glGenProgramPipelines(1, &m_RendererID));
+
+	bool stagesValid = true;
+
+	// Use each stage program for its stage of the pipeline, no linking happens here
+	for (const StageProgram* stage : stages)
+	{
+		if (!stage->IsValid())
+		{
+			stagesValid = false;
+			continue;
+		}
+
+		GLCall(glUseProgramStages(m_RendererID, GetShaderStageBit(stage->GetStage()), stage->GetRendererID()));
+	}
+
+	if (!stagesValid)
+		return;
+
+	// Check the stages fit together (matching interfaces etc) once here rather than on every draw
+	GLCall(glValidateProgramPipeline(m_RendererID));
+
+	int pipeline_valid;
+	GLCall(glGetProgramPipelineiv(m_RendererID, GL_VALIDATE_STATUS, &pipeline_valid));
+
+	if (pipeline_valid != GL_TRUE)
+	{
+		GLsizei log_length = 0;
+		GLchar message[1024] = "";
+		GLCall(glGetProgramPipelineInfoLog(m_RendererID, 1024, &log_length, message));
+
+		std::cout << "Failed to validate program pipeline, message: " << message << std::endl;
+		return;
+	}
+
+	m_bValid = true;
+}
+
+ProgramPipeline::~ProgramPipeline()
+{
+	GLCall(glDeleteProgramPipelines(1, &m_RendererID));
+}
+
+void ProgramPipeline::Bind() const
+{
+	StateCache::UseProgram(0);
+	GLCall(glBindProgramPipeline(m_RendererID));
+}
+
+void ProgramPipeline::Unbind() const
+{
+	GLCall(glBindProgramPipeline(0));
+}
+
+StageProgram& PipelineLibrary::GetStage(const std::string& name, const shaderProgSource& source, ShaderStage stage, const ShaderDefines& defines)
+{
+	// Keyed on the text of this stage alone so files sharing an identical stage share the stage program
+	unsigned long long key = HashBytes(GetShaderStageName(stage));
+	key = HashBytes(source.GetStage(stage).text, key);
+	key = defines.GetHash(key);
+
+	std::unique_ptr<StageProgram>& stageProgram = m_StagePrograms[key];
+
+	if (!stageProgram)
+		stageProgram = std::make_unique<StageProgram>(name, source, stage, defines.GetPrelude());
+
+	return *stageProgram;
+}
+
+ProgramPipeline* PipelineLibrary::GetPipeline(std::initializer_list<const StageProgram*> stages)
+{
+	pipelineStages key = {};
+
+	for (const StageProgram* stage : stages)
+	{
+		// A failed stage has no program, caching a pipeline for it would hand out a broken pipeline for good
+		if (!stage->IsValid())
+		{
+			std::cout << "Not creating a program pipeline with a " << GetShaderStageName(stage->GetStage()) << " stage that failed to build" << std::endl;
+			return nullptr;
+		}
+
+		const StageProgram*& slot = key[(unsigned int)stage->GetStage()];
+
+		if (slot)
+		{
+			std::cout << "Not creating a program pipeline with two " << GetShaderStageName(stage->GetStage()) << " stages" << std::endl;
+			return nullptr;
+		}
+
+		slot = stage;
+	}
+
+	std::unique_ptr<ProgramPipeline>& pipeline = m_Pipelines[key];
+
+	if (!pipeline)
+		pipeline = std::make_unique<ProgramPipeline>(stages);
+
+	return pipeline.get();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "StageProgram.h"
+
+// A program pipeline object built from separable stage programs. Putting stages together is done by the pipeline
+// rather than by linking, so any combination of already compiled stages can be used without another link.
+class ProgramPipeline
+{
+private:
+
+	unsigned int m_RendererID;
+	bool m_bValid;
+
+public:
+
+	// One stage program per stage used by the pipeline
+	ProgramPipeline(std::initializer_list<const StageProgram*> stages);
+	~ProgramPipeline();
+
+	ProgramPipeline(const ProgramPipeline&) = delete;
+	ProgramPipeline& operator=(const ProgramPipeline&) = delete;
+
+	// A bound program takes priority over a pipeline so this also unbinds any program
+	void Bind() const;
+	void Unbind() const;
+
+	inline bool IsValid() const { return m_bValid; }
+
+	// Core in 4.1, otherwise needs ARB_separate_shader_objects
+	static bool IsSupported();
+};
+
+// Compiles each stage of a shader library once and combines stages into pipelines on demand.
+// With N vertex and M fragment stages this does N + M links rather than the N * M a program per pair would need.
+class PipelineLibrary
+{
+private:
+
+	std::unordered_map<unsigned long long, std::unique_ptr<StageProgram>> m_StagePrograms;
+
+	// The stage programs of a pipeline indexed by stage, so the order they were passed in doesn't matter.
+	// The library owns the stage programs and never frees them before itself, so their addresses stay unique.
+	using pipelineStages = std::array<const StageProgram*, ShaderStageCount>;
+
+	std::map<pipelineStages, std::unique_ptr<ProgramPipeline>> m_Pipelines;
+
+public:
+
+	// The stage program for one stage of a parsed file and define set, linked the first time it is asked for
+	StageProgram& GetStage(const std::string& name, const shaderProgSource& source, ShaderStage stage, const ShaderDefines& defines = ShaderDefines());
+
+	// The pipeline combining these stage programs in any order, created the first time the combination is asked for.
+	// Returns nullptr without creating anything if a stage failed to build or two stages are of the same type.
+	ProgramPipeline* GetPipeline(std::initializer_list<const StageProgram*> stages);
+
+	// Every stage program is one link
+	inline unsigned int GetLinkCount() const { return (unsigned int)m_StagePrograms.size(); }
+	inline unsigned int GetPipelineCount() const { return (unsigned int)m_Pipelines.size(); }
+};
@@ -0,0 +1,72 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+unsigned long long RenderQueue::MakeKey(unsigned int layer, unsigned int shader, unsigned int vertexArray, unsigned int material, float depth)
+{
+	depth = std::min(std::max(depth, 0.0f), 1.0f);
+
+	unsigned long long depthBits = (unsigned long long)(depth * ((1 << DepthBits) - 1));
+
+	unsigned long long key = layer & ((1 << LayerBits) - 1);
+	key = (key << ShaderBits) | (shader & ((1 << ShaderBits) - 1));
+	key = (key << VertexArrayBits) | (vertexArray & ((1 << VertexArrayBits) - 1));
+	key = (key << MaterialBits) | (material & ((1 << MaterialBits) - 1));
+	key = (key << DepthBits) | depthBits;
+
+	return key;
+}
+
+void RenderQueue::Sort()
+{
+	size_t count = m_vItems.size();
+
+	// Not worth building histograms for a handful of draws
+	if (count < 64)
+	{
+		std::stable_sort(m_vItems.begin(), m_vItems.end(), [](const renderItem& a, const renderItem& b) { return a.key < b.key; });
+		return;
+	}
+
+	// Count every byte of every key in one pass over the items
+	unsigned int histograms[8][256] = {};
+
+	for (const renderItem& item : m_vItems)
+	{
+		for (unsigned int pass = 0; pass < 8; pass++)
+			histograms[pass][(item.key >> (pass * 8)) & 0xFF]++;
+	}
+
+	m_vScratch.resize(count);
+
+	renderItem* source = m_vItems.data();
+	renderItem* destination = m_vScratch.data();
+
+	for (unsigned int pass = 0; pass < 8; pass++)
+	{
+		unsigned int* histogram = histograms[pass];
+
+		// Every key has the same byte here (eg the unused high layers or a constant depth), the pass would change nothing
+		if (histogram[(source[0].key >> (pass * 8)) & 0xFF] == count)
+			continue;
+
+		// Turn the counts into the offset each byte value starts at
+		unsigned int offset = 0;
+
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			unsigned int bucketCount = histogram[i];
+			histogram[i] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			destination[histogram[(source[i].key >> (pass * 8)) & 0xFF]++] = source[i];
+
+		std::swap(source, destination);
+	}
+
+	// An odd number of passes leaves the sorted items in the scratch buffer
+	if (source != m_vItems.data())
+		m_vItems.swap(m_vScratch);
+}
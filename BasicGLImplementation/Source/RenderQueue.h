@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+// One queued draw, the payload is an index into whatever holds the draw's details
+struct renderItem
+{
+	unsigned long long	key;
+	unsigned int		payload;
+};
+
+// Draws packed into 64 bit sort keys and radix sorted once a frame, so draws sharing a shader and vertex array
+// end up next to each other and the state cache can skip most of the binds between them.
+// From the most significant bits down a key holds:
+//   layer (4 bits)  shader (14 bits)  vertex array (14 bits)  material (16 bits)  depth (16 bits)
+// so layers are drawn in order, then everything is grouped by the most expensive state to change, and depth only
+// orders draws that share all their state (front to back, so early depth testing can reject more).
+class RenderQueue
+{
+private:
+
+	std::vector<renderItem> m_vItems;
+
+	// Ping-pong buffer for the radix passes, kept to avoid allocating every frame
+	std::vector<renderItem> m_vScratch;
+
+public:
+
+	static constexpr unsigned int LayerBits = 4;
+	static constexpr unsigned int ShaderBits = 14;
+	static constexpr unsigned int VertexArrayBits = 14;
+	static constexpr unsigned int MaterialBits = 16;
+	static constexpr unsigned int DepthBits = 16;
+
+	// GL names larger than their field are wrapped, which only costs sorting quality. Depth is clamped to 0-1.
+	static unsigned long long MakeKey(unsigned int layer, unsigned int shader, unsigned int vertexArray, unsigned int material, float depth);
+
+	inline void Push(unsigned long long key, unsigned int payload) { m_vItems.push_back({ key, payload }); }
+
+	// Stable LSD radix sort on the keys, a byte per pass. Passes over bytes that are the same in every key are skipped.
+	void Sort();
+
+	inline void Clear() { m_vItems.clear(); }
+
+	inline const std::vector<renderItem>& GetItems() const { return m_vItems; }
+	inline unsigned int GetCount() const { return (unsigned int)m_vItems.size(); }
+};
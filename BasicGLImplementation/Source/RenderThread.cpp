@@ -0,0 +1,101 @@
+#include "RenderThread.h"
+
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "Renderer.h"
+
+RenderThread::RenderThread(GLFWwindow* window, Renderer& renderer, std::function<void()> beginFrame)
+	: m_pWindow(window), m_Renderer(renderer), m_BeginFrame(std::move(beginFrame)), m_iPublished(0), m_iRendered(0),
+	  m_bRecording(false), m_iFramesSkipped(0), m_bRunning(true)
+{
+	// A context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+
+	m_Thread = std::thread(&RenderThread::Run, this);
+}
+
+RenderThread::~RenderThread()
+{
+	m_bRunning = false;
+	m_Thread.join();
+
+	// GL objects owned by the application are destroyed on this thread after this
+	glfwMakeContextCurrent(m_pWindow);
+}
+
+CommandList* RenderThread::TryBeginFrame()
+{
+	unsigned int published = m_iPublished.load(std::memory_order_relaxed);
+
+	// Acquire pairs with the render thread's release, its reads of the slot are finished before it is reused
+	if (published - m_iRendered.load(std::memory_order_acquire) >= FrameCount)
+	{
+		m_iFramesSkipped++;
+		return nullptr;
+	}
+
+	CommandList& frame = m_Frames[published % FrameCount];
+	frame.Reset();
+
+	m_bRecording = true;
+
+	return &frame;
+}
+
+void RenderThread::EndFrame()
+{
+	if (!m_bRecording)
+		return;
+
+	m_bRecording = false;
+
+	// Release makes the recorded commands visible to the render thread before it sees the new count
+	m_iPublished.store(m_iPublished.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void RenderThread::Run()
+{
+	glfwMakeContextCurrent(m_pWindow);
+
+	for (;;)
+	{
+		// Read the flag first so frames published before shutdown are still rendered
+		bool running = m_bRunning;
+
+		unsigned int rendered = m_iRendered.load(std::memory_order_relaxed);
+
+		if (rendered == m_iPublished.load(std::memory_order_acquire))
+		{
+			if (!running)
+				break;
+
+			// Nothing to draw yet, the application thread is still recording
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			continue;
+		}
+
+		// Blocks only if the GPU is still behind by every frame in flight
+		m_Renderer.BeginFrame();
+
+		if (m_BeginFrame)
+			m_BeginFrame();
+
+		m_Renderer.Clear();
+
+		m_Frames[rendered % FrameCount].Execute(m_Renderer);
+
+		m_Renderer.EndFrame();
+		GLErrorCheck::EndFrame();
+
+		// Can block on vsync, which now only holds up this thread
+		glfwSwapBuffers(m_pWindow);
+
+		// The slot is free for the application to record into again
+		m_iRendered.store(rendered + 1, std::memory_order_release);
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
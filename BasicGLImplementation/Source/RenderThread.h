@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "CommandList.h"
+
+struct GLFWwindow;
+class Renderer;
+
+// Moves all GL work onto a thread of its own so the application thread only polls input, simulates and records.
+// While it runs the render thread owns the window's context. The application records each frame into a CommandList
+// taken from a bounded lock-free queue of frames, and the render thread executes and presents them in order.
+// A slow swap then only holds up the render thread. When every frame is queued or in flight, TryBeginFrame returns
+// nullptr and the application can keep handling input instead of waiting.
+class RenderThread
+{
+public:
+
+	static constexpr unsigned int FrameCount = 3;
+
+private:
+
+	GLFWwindow* m_pWindow;
+	Renderer& m_Renderer;
+
+	// Run on the render thread at the start of every frame, eg to finish shader compiles and apply hot reloads
+	std::function<void()> m_BeginFrame;
+
+	// Single producer single consumer ring, frame n lives in m_Frames[n % FrameCount].
+	// Only the application thread writes m_iPublished and only the render thread writes m_iRendered,
+	// so a slot can be recorded into once the frame that used it before has been rendered.
+	CommandList m_Frames[FrameCount];
+
+	std::atomic<unsigned int> m_iPublished;
+	std::atomic<unsigned int> m_iRendered;
+
+	bool m_bRecording;
+
+	unsigned int m_iFramesSkipped;
+
+	std::atomic<bool> m_bRunning;
+	std::thread m_Thread;
+
+	void Run();
+
+public:
+
+	// The window's context must be current on the calling thread, it is released and made current on the render thread
+	RenderThread(GLFWwindow* window, Renderer& renderer, std::function<void()> beginFrame = nullptr);
+
+	// Renders whatever is still queued, stops the thread and makes the context current on the calling thread again
+	~RenderThread();
+
+	// The command list to record the next frame into, nullptr if the queue is full
+	CommandList* TryBeginFrame();
+
+	// Hand the recorded frame to the render thread
+	void EndFrame();
+
+	inline unsigned int GetFramesRendered() const { return m_iRendered.load(std::memory_order_relaxed); }
+
+	// Times TryBeginFrame found the queue full
+	inline unsigned int GetFramesSkipped() const { return m_iFramesSkipped; }
+};
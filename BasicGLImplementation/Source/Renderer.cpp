@@ -3,20 +3,351 @@
 #include "GL/glew.h"
 
 #include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#include "GLDebugLog.h"
+#include "Hash.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "StateCache.h"
+#include "VertexArray.h"
+
+GLErrorMode GLErrorCheck::s_Mode = GLErrorMode::PerCall;
+
+const char* GLErrorCheck::s_CurrentFunction = nullptr;
+const char* GLErrorCheck::s_CurrentFile = nullptr;
+int GLErrorCheck::s_CurrentLine = 0;
+
+std::vector<glCallSiteErrors> GLErrorCheck::s_vCallSites;
+
+GLDebugLog* GLErrorCheck::s_pLog = nullptr;
+
+unsigned int GLErrorCheck::s_iFrameErrors = 0;
+unsigned int GLErrorCheck::s_iTotalErrors = 0;
+
+static const char* GetDebugSourceName(GLenum source)
+{
+    switch (source)
+    {
+    case GL_DEBUG_SOURCE_API:                   return "API";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:         return "Window System";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER:       return "Shader Compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:           return "Third Party";
+    case GL_DEBUG_SOURCE_APPLICATION:           return "Application";
+    }
+
+    return "Other";
+}
+
+static const char* GetDebugTypeName(GLenum type)
+{
+    switch (type)
+    {
+    case GL_DEBUG_TYPE_ERROR:                   return "Error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:     return "Deprecated";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:      return "Undefined Behaviour";
+    case GL_DEBUG_TYPE_PORTABILITY:             return "Portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:             return "Performance";
+    case GL_DEBUG_TYPE_MARKER:                  return "Marker";
+    }
+
+    return "Other";
+}
+
+// Called by the driver in DebugCallback mode, synchronous output means it runs inside the GL call that caused it
+static void GLAPIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, [[maybe_unused]] const void* userParam)
+{
+    // Notifications are things like buffer placement hints, far too chatty to print
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+
+    // The same id can mean different things from different sources, so all three make up the key
+    unsigned long long key = ((unsigned long long)source << 48) ^ ((unsigned long long)type << 32) ^ id;
+
+    // No allocation here, this can be called many times a frame during an error storm
+    char prefix[96];
+    std::snprintf(prefix, sizeof(prefix), "[OpenGL %s] %s %s %u - ", type == GL_DEBUG_TYPE_ERROR ? "ERROR" : "DEBUG", GetDebugSourceName(source), GetDebugTypeName(type), id);
+
+    // Errors break into the debugger below, print them now in case that ends the process
+    bool immediate = type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH;
+
+    GLErrorCheck::Print(key, prefix, std::string_view(message, length >= 0 ? length : std::strlen(message)), immediate);
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+    {
+        // The message id is driver specific rather than a GL error code, the message text above is what says what went wrong
+        GLErrorCheck::RecordError(nullptr, nullptr, 0, GL_NO_ERROR);
+
+        DEBUG_BREAK();
+    }
+}
+
+void GLErrorCheck::SetMode(GLErrorMode mode)
+{
+    if (mode == GLErrorMode::DebugCallback && !GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+    {
+        std::cout << "KHR_debug isn't available, checking GL errors after every call instead" << std::endl;
+        mode = GLErrorMode::PerCall;
+    }
+
+    // Turn the callback off when leaving DebugCallback mode so errors aren't reported twice
+    if (s_Mode == GLErrorMode::DebugCallback && mode != GLErrorMode::DebugCallback)
+    {
+        glDisable(GL_DEBUG_OUTPUT);
+        glDebugMessageCallback(nullptr, nullptr);
+    }
+
+    if (mode == GLErrorMode::DebugCallback)
+    {
+        // Errors found by glGetError before the callback was set up would never be reported otherwise
+        ClearErrors();
+
+        glEnable(GL_DEBUG_OUTPUT);
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(DebugMessageCallback, nullptr);
+    }
+
+    s_Mode = mode;
+}
+
+bool GLErrorCheck::ParseMode(std::string_view text, GLErrorMode& mode)
+{
+    if (text == "off")
+        mode = GLErrorMode::Off;
+    else if (text == "frame")
+        mode = GLErrorMode::PerFrame;
+    else if (text == "call")
+        mode = GLErrorMode::PerCall;
+    else if (text == "debug")
+        mode = GLErrorMode::DebugCallback;
+    else
+        return false;
+
+    return true;
+}
+
+void GLErrorCheck::RecordError(const char* function, const char* file, int line, unsigned int error)
+{
+    // The debug callback doesn't know the call, it was stored by BeginCall
+    if (!file)
+    {
+        function = s_CurrentFunction;
+        file = s_CurrentFile;
+        line = s_CurrentLine;
+    }
+
+    s_iTotalErrors++;
+
+    if (!file)
+        return;
+
+    // Errors are rare so the sites are only looked up once something has gone wrong
+    for (glCallSiteErrors& callSite : s_vCallSites)
+    {
+        if (callSite.line == line && std::string_view(callSite.file) == file)
+        {
+            callSite.count++;
+            return;
+        }
+    }
+
+    s_vCallSites.push_back({ function, file, line, 1 });
+
+    char errorText[32] = "debug message";
+
+    if (error != GL_NO_ERROR)
+        std::snprintf(errorText, sizeof(errorText), "0x%04X", error);
+
+    std::string message = std::string(errorText) + " Function name : " + function + " File name : " + file + " Line number : " + std::to_string(line);
+
+    // The GLCall's ASSERT follows, so this can't wait for the log thread
+    Print(HashBytes(file, (unsigned long long)line), "[OpenGL ERROR] - ", message, true);
+}
+
+void GLErrorCheck::Print(unsigned long long key, std::string_view prefix, std::string_view message, bool immediate)
+{
+    if (s_pLog && !immediate)
+        s_pLog->Push(key, prefix, message);
+    else
+        std::cout << prefix << message << std::endl;
+}
 
 // Use glGetError to clear all existing errors
-void GLClearError()
+void GLErrorCheck::ClearErrors()
 {
     while (glGetError() != GL_NO_ERROR);
 }
 
 // Use glGetError to get current errors
-bool GLLogCall(const char* function, const char* file, int line)
+bool GLErrorCheck::LogErrors(const char* function, const char* file, int line)
 {
+    bool succeeded = true;
+
     while (GLenum error = glGetError())
     {
-        std::cout << "[OpenGL ERROR] - " << error << "'Function name : " << function << " File name : " << file << " Line number : " << line << std::endl;
-        return false;
+        RecordError(function, file, line, error);
+        succeeded = false;
     }
-    return true;
-}
\ No newline at end of file
+
+    return succeeded;
+}
+
+void GLErrorCheck::EndFrame()
+{
+    if (s_Mode != GLErrorMode::PerFrame)
+        return;
+
+    // One round trip per frame, the errors could have come from any call since the last one
+    unsigned int errors = 0;
+    GLenum lastError = GL_NO_ERROR;
+
+    while (GLenum error = glGetError())
+    {
+        lastError = error;
+        errors++;
+    }
+
+    if (errors == 0)
+        return;
+
+    s_iFrameErrors += errors;
+    s_iTotalErrors += errors;
+
+    std::string message = std::to_string(errors) + " error(s) this frame, last: " + std::to_string(lastError) + ", run with per call checking to find them";
+
+    // Keyed on the error so a persistent error is printed once and then summarised by the log
+    Print(lastError, "[OpenGL ERROR] - ", message);
+}
+
+void GLErrorCheck::ReportCallSites()
+{
+    if (s_iTotalErrors == 0)
+        return;
+
+    std::cout << "OpenGL errors: " << s_iTotalErrors << " in total" << std::endl;
+
+    if (s_iFrameErrors != 0)
+        std::cout << "    " << s_iFrameErrors << " found at the end of a frame" << std::endl;
+
+    for (const glCallSiteErrors& callSite : s_vCallSites)
+        std::cout << "    " << callSite.count << " from " << callSite.function << " at " << callSite.file << "(" << callSite.line << ")" << std::endl;
+}
+
+Renderer::Renderer(unsigned int framesInFlight)
+    : m_FrameContext(framesInFlight), m_FrameStats{ 0, 0, 0, 0, 0.0 }, m_LastFrameStats{ 0, 0, 0, 0, 0.0 }
+{
+}
+
+void Renderer::BeginFrame()
+{
+    m_FrameContext.BeginFrame();
+
+    m_FrameStats.cpuWaitMs = m_FrameContext.GetLastWaitMs();
+}
+
+void Renderer::Clear() const
+{
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void Renderer::Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, int baseVertex)
+{
+    if (shader.IsCompute())
+    {
+        std::cout << "Can't draw with " << shader.GetFilePath() << ", it is a compute program" << std::endl;
+        return;
+    }
+
+    // Each of these is skipped by the state cache if it is already bound
+    shader.Bind();
+    vertexArray.Bind();
+    indexBuffer.Bind();
+
+    // The count and type come from the index buffer rather than being assumed
+    if (baseVertex == 0)
+    {
+        GLCall(glDrawElements(GL_TRIANGLES, indexBuffer.GetCount(), indexBuffer.GetType(), nullptr));
+    }
+    else
+    {
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, indexBuffer.GetCount(), indexBuffer.GetType(), nullptr, baseVertex));
+    }
+
+    m_FrameStats.drawCalls++;
+    m_FrameStats.triangles += indexBuffer.GetCount() / 3;
+}
+
+UniformValues& Renderer::Submit(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, unsigned int layer, unsigned int material, float depth, int baseVertex)
+{
+    // Only the key is sorted, the draw itself stays where it was pushed
+    unsigned long long key = RenderQueue::MakeKey(layer, shader.GetRendererID(), vertexArray.GetRendererID(), material, depth);
+
+    // In the arena rather than the draw so the reference stays valid as more draws are pushed
+    UniformValues* uniforms = m_DrawArena.New<UniformValues>(m_DrawArena);
+
+    m_Queue.Push(key, (unsigned int)m_vDraws.size());
+    m_vDraws.push_back({ &vertexArray, &indexBuffer, &shader, material, baseVertex, uniforms });
+
+    return *uniforms;
+}
+
+UniformValues& Renderer::GetMaterial(unsigned int material)
+{
+    if (material >= m_vMaterials.size())
+        m_vMaterials.resize(material + 1, nullptr);
+
+    if (!m_vMaterials[material])
+        m_vMaterials[material] = m_MaterialArena.New<UniformValues>(m_MaterialArena);
+
+    return *m_vMaterials[material];
+}
+
+void Renderer::ClearMaterials()
+{
+    m_vMaterials.clear();
+    m_MaterialArena.Reset();
+}
+
+void Renderer::Flush()
+{
+    // Draws with the same shader and vertex array end up together so the state cache skips their binds
+    m_Queue.Sort();
+
+    for (const renderItem& item : m_Queue.GetItems())
+    {
+        const drawCommand& command = m_vDraws[item.payload];
+
+        // Uniforms need the program bound, Draw's own bind is then skipped by the state cache
+        command.shader->Bind();
+
+        // Draws sharing a material are next to each other, the uniform cache skips its values after the first
+        if (command.material != 0 && command.material < m_vMaterials.size() && m_vMaterials[command.material])
+            m_vMaterials[command.material]->Apply(*command.shader);
+
+        command.uniforms->Apply(*command.shader);
+
+        Draw(*command.vertexArray, *command.indexBuffer, *command.shader, command.baseVertex);
+    }
+
+    m_Queue.Clear();
+    m_vDraws.clear();
+    m_DrawArena.Reset();
+}
+
+void Renderer::EndFrame()
+{
+    Flush();
+
+    // Everything the frame submitted is behind this fence, BeginFrame waits on it when the slot comes round again
+    m_FrameContext.EndFrame();
+
+    StateCache::EndFrame();
+
+    m_FrameStats.stateChanges = StateCache::GetFrameIssued();
+    m_FrameStats.stateElided = StateCache::GetFrameElided();
+
+    m_LastFrameStats = m_FrameStats;
+    m_FrameStats = { 0, 0, 0, 0, 0.0 };
+}
@@ -1,14 +1,219 @@
 #pragma once
 
-#define ASSERT(x) if (!(x)) __debugbreak();
+// Stop in the debugger, __debugbreak only exists on MSVC
+#if defined(_MSC_VER)
+	#define DEBUG_BREAK() __debugbreak()
+#else
+	#include <csignal>
+	#include <cstdlib>
 
-#define GLCall(x) GLClearError();\
+	#ifdef SIGTRAP
+		#define DEBUG_BREAK() std::raise(SIGTRAP)
+	#else
+		#define DEBUG_BREAK() std::abort()
+	#endif
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+// The checking done around each call depends on the GLErrorMode chosen at startup.
+// Not wrapped in braces so declarations like GLCall(int location = glGetUniformLocation(...)) stay in scope.
+#define GLCall(x) GLErrorCheck::BeginCall(#x, __FILE__, __LINE__);\
                   x;\
-                  ASSERT(GLLogCall(#x, __FILE__, __LINE__ ))
+                  ASSERT(GLErrorCheck::EndCall(#x, __FILE__, __LINE__))
+
+#include <string_view>
+#include <vector>
+
+#include "RenderQueue.h"
+#include "FrameContext.h"
+#include "Arena.h"
+#include "UniformValues.h"
+
+class GLDebugLog;
+class VertexArray;
+class IndexBuffer;
+class Shader;
+
+enum class GLErrorMode
+{
+	Off,			// no checking at all
+	PerFrame,		// glGetError once a frame in EndFrame, errors are counted but can't be tied to a call
+	PerCall,		// glGetError before and after every GLCall, two driver round trips per call
+	DebugCallback	// KHR_debug reports errors as they happen, attributed to the GLCall being made
+};
+
+// Errors raised by one GLCall in the source
+struct glCallSiteErrors
+{
+	const char*		function;
+	const char*		file;
+	int				line;
+	unsigned int	count;
+};
+
+class GLErrorCheck
+{
+private:
+
+	static GLErrorMode s_Mode;
+
+	// The GLCall in progress, only tracked in DebugCallback mode so the synchronous callback knows who to blame
+	static const char* s_CurrentFunction;
+	static const char* s_CurrentFile;
+	static int s_CurrentLine;
+
+	static std::vector<glCallSiteErrors> s_vCallSites;
+
+	static GLDebugLog* s_pLog;
+
+	static unsigned int s_iFrameErrors;
+	static unsigned int s_iTotalErrors;
+
+	static void ClearErrors();
+	static bool LogErrors(const char* function, const char* file, int line);
+
+public:
+
+	// Choose how GLCall checks for errors, call once after glewInit.
+	// DebugCallback needs GL 4.3 or KHR_debug and falls back to PerCall without them.
+	static void SetMode(GLErrorMode mode);
+	static inline GLErrorMode GetMode() { return s_Mode; }
+
+	// "off", "frame", "call" or "debug", returns false for anything else
+	static bool ParseMode(std::string_view text, GLErrorMode& mode);
+
+	// Send error and debug messages to an asynchronous log instead of printing them on the calling thread.
+	// The log must outlive every GL call made while it is set, pass nullptr to print directly again.
+	static void SetLog(GLDebugLog* log) { s_pLog = log; }
+
+	// Print through the log if there is one, key identifies the message for deduplication.
+	// Immediate messages skip the log and are printed before returning, for errors that are about to hit DEBUG_BREAK
+	// and would otherwise die in the queue with the process.
+	static void Print(unsigned long long key, std::string_view prefix, std::string_view message, bool immediate = false);
+
+	// Count an error against the call site, prints the first error from each site straight away.
+	// error is the glGetError code, GL_NO_ERROR (0) for errors reported by the debug callback.
+	static void RecordError(const char* function, const char* file, int line, unsigned int error);
+
+	// Once a frame, collects the frame's errors in PerFrame mode
+	static void EndFrame();
+
+	// Print every call site that has raised errors and how many times
+	static void ReportCallSites();
+
+	static inline unsigned int GetTotalErrors() { return s_iTotalErrors; }
+	static inline const std::vector<glCallSiteErrors>& GetCallSites() { return s_vCallSites; }
+
+	static inline void BeginCall(const char* function, const char* file, int line)
+	{
+		if (s_Mode == GLErrorMode::PerCall)
+		{
+			ClearErrors();
+		}
+		else if (s_Mode == GLErrorMode::DebugCallback)
+		{
+			s_CurrentFunction = function;
+			s_CurrentFile = file;
+			s_CurrentLine = line;
+		}
+	}
+
+	// Returns false if the call raised an error (only known in PerCall mode)
+	static inline bool EndCall(const char* function, const char* file, int line)
+	{
+		if (s_Mode == GLErrorMode::PerCall)
+			return LogErrors(function, file, line);
+
+		// Anything reported after this came from a GL call made outside of GLCall
+		if (s_Mode == GLErrorMode::DebugCallback)
+			s_CurrentFile = nullptr;
+
+		return true;
+	}
+};
+
+// Counts for one frame of rendering
+struct renderStats
+{
+	unsigned int drawCalls;
+	unsigned int triangles;
+	unsigned int stateChanges;	// binds and enables that went to the driver
+	unsigned int stateElided;	// redundant ones the state cache skipped
+	double cpuWaitMs;			// time BeginFrame spent waiting for the GPU to finish an older frame
+};
+
+class Renderer
+{
+private:
+
+	struct drawCommand
+	{
+		const VertexArray*	vertexArray;
+		const IndexBuffer*	indexBuffer;
+		Shader*				shader;
+		unsigned int		material;
+		int					baseVertex;
+		UniformValues*		uniforms;
+	};
+
+	// Draws submitted since the last Flush in submission order, the render queue's payloads index into this
+	std::vector<drawCommand> m_vDraws;
+
+	// Holds the per draw uniform values, reset by every Flush
+	Arena m_DrawArena;
+
+	// Uniform values of each material id, nullptr for ids that were never given any
+	std::vector<UniformValues*> m_vMaterials;
+	Arena m_MaterialArena;
+
+	RenderQueue m_Queue;
+
+	FrameContext m_FrameContext;
+
+	renderStats m_FrameStats;
+	renderStats m_LastFrameStats;
+
+public:
+
+	// Must be constructed after the GL context has been created
+	Renderer(unsigned int framesInFlight = 3);
+
+	// Start a frame, waiting for the GPU first if it is still using the frame slot this frame reuses
+	void BeginFrame();
+
+	void Clear() const;
+
+	// Bind everything and draw the whole index buffer as triangles now.
+	// A shader that isn't ready yet draws with the fallback program.
+	// baseVertex is added to every index, which is how geometry in a StreamingVertexBuffer allocation is drawn.
+	void Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, int baseVertex = 0);
+
+	// Queue a draw for the next Flush, the objects must stay alive until then.
+	// Layers are drawn in order, material selects the uniform values set with GetMaterial and depth (0-1) orders draws
+	// that share everything else front to back. See RenderQueue for how these are packed.
+	// Uniforms that differ per draw are set on the returned values, they are applied after the material's just before
+	// the draw is made. Uniforms set on the Shader itself are shared by all of its queued draws.
+	// baseVertex is passed on to Draw, for geometry in a StreamingVertexBuffer allocation.
+	UniformValues& Submit(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader,
+		unsigned int layer = 0, unsigned int material = 0, float depth = 0.0f, int baseVertex = 0);
+
+	// The uniform values every draw submitted with this material id gets, kept until ClearMaterials. Material 0 is
+	// for draws with no shared values and is never applied. Setting a value again replaces it, so the material can
+	// be updated every frame without growing.
+	UniformValues& GetMaterial(unsigned int material);
+
+	// Forget every material's values
+	void ClearMaterials();
+
+	// Sort everything queued with Submit by its state and draw it
+	void Flush();
 
+	// Flush, fence the frame, then finish the frame's statistics (including the StateCache counts)
+	void EndFrame();
 
-// Use glGetError to clear all existing errors
-void GLClearError();
+	inline const renderStats& GetFrameStats() const { return m_LastFrameStats; }
 
-// Use glGetError to get current errors
-bool GLLogCall(const char* function, const char* file, int line);
+	// Per frame resources are picked with its frame slot
+	inline const FrameContext& GetFrameContext() const { return m_FrameContext; }
+};
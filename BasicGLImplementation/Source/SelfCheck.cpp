@@ -0,0 +1,185 @@
+#include "SelfCheck.h"
+
+#include <iostream>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "ShaderStorageBuffer.h"
+
+static bool Report(const char* name, bool passed, const char* detail = "")
+{
+	std::cout << "Self check " << name << (passed ? " passed" : " FAILED") << (*detail ? ": " : "") << detail << std::endl;
+	return passed;
+}
+
+// A 1x1 RGBA8 framebuffer drawn into instead of the window, bound for as long as it exists
+class offscreenTarget
+{
+private:
+
+	unsigned int m_Framebuffer;
+	unsigned int m_Renderbuffer;
+	int m_Viewport[4];
+
+public:
+
+	offscreenTarget()
+	{
+		GLCall(glGetIntegerv(GL_VIEWPORT, m_Viewport));
+
+		GLCall(glGenRenderbuffers(1, &m_Renderbuffer));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_Renderbuffer));
+		GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1));
+
+		GLCall(glGenFramebuffers(1, &m_Framebuffer));
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer));
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_Renderbuffer));
+
+		GLCall(glViewport(0, 0, 1, 1));
+	}
+
+	~offscreenTarget()
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GLCall(glDeleteFramebuffers(1, &m_Framebuffer));
+		GLCall(glDeleteRenderbuffers(1, &m_Renderbuffer));
+
+		GLCall(glViewport(m_Viewport[0], m_Viewport[1], m_Viewport[2], m_Viewport[3]));
+	}
+
+	bool IsComplete() const
+	{
+		GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+		return status == GL_FRAMEBUFFER_COMPLETE;
+	}
+
+	void ReadPixel(unsigned char* rgba) const
+	{
+		GLCall(glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba));
+	}
+};
+
+unsigned int SelfCheck::RunAll()
+{
+	unsigned int failed = 0;
+
+	if (!IntegerAttributes())
+		failed++;
+
+	if (!ComputeDispatch())
+		failed++;
+
+	std::cout << "Self checks finished, " << failed << " failed" << std::endl;
+
+	return failed;
+}
+
+bool SelfCheck::IntegerAttributes()
+{
+	Shader shader("Res/Shaders/IntegerAttributeCheck.shader");
+
+	if (!shader.IsReady())
+		return Report("integer attributes", false, "the shader didn't build");
+
+	VertexBufferLayout intLayout;
+	intLayout.Push<int>(2, "a_Value");
+
+	VertexBufferLayout floatLayout;
+	floatLayout.Push<float>(2, "a_Value");
+
+	VertexBufferLayout normalisedLayout;
+	normalisedLayout.Push<unsigned int>(2, "a_Value");
+
+	// The rejections print why, which is expected here
+	if (!shader.IsCompatible(intLayout))
+		return Report("integer attributes", false, "GL_INT data was rejected for an ivec2 attribute");
+
+	if (shader.IsCompatible(floatLayout) || shader.IsCompatible(normalisedLayout))
+		return Report("integer attributes", false, "float converted data was accepted for an ivec2 attribute");
+
+	// Every vertex carries the same value, the shader turns the pixel green only if it arrived unconverted
+	int values[] = { 123456, -7, 123456, -7, 123456, -7 };
+	unsigned int indices[] = { 0, 1, 2 };
+
+	offscreenTarget target;
+
+	if (!target.IsComplete())
+		return Report("integer attributes", false, "the offscreen framebuffer is incomplete");
+
+	VertexArray vertexArray;
+	VertexBuffer vertexBuffer(values, sizeof(values));
+	vertexArray.AddBuffer(vertexBuffer, intLayout, shader);
+
+	IndexBuffer indexBuffer(indices, 3);
+
+	Renderer renderer;
+	renderer.Clear();
+	renderer.Draw(vertexArray, indexBuffer, shader);
+
+	unsigned char pixel[4] = { 0, 0, 0, 0 };
+	target.ReadPixel(pixel);
+
+	vertexArray.Unbind();
+	shader.Unbind();
+
+	bool passed = pixel[0] == 0 && pixel[1] == 255 && pixel[2] == 0;
+
+	return Report("integer attributes", passed, passed ? "" : "the shader read different values than were uploaded");
+}
+
+bool SelfCheck::ComputeDispatch()
+{
+	// The check shader is written for 4.3 rather than the ARB_compute_shader extension
+	if (!Shader::IsComputeSupported() || !GLEW_VERSION_4_3)
+		return Report("compute dispatch", true, "skipped, needs GL 4.3");
+
+	Shader shader("Res/Shaders/ComputeCheck.shader");
+
+	if (!shader.IsReady() || !shader.IsCompute())
+		return Report("compute dispatch", false, "the shader didn't build");
+
+	// Everything past the items the dispatch covers has to keep its initial value
+	const unsigned int itemCount = 1000;
+	const unsigned int bufferCount = 1024;
+
+	unsigned int values[bufferCount];
+
+	for (unsigned int i = 0; i < bufferCount; i++)
+		values[i] = 0xFFFFFFFF;
+
+	ShaderStorageBuffer buffer(sizeof(values), 0, values);
+
+	if (!shader.BindStorageBlock("Values", buffer))
+		return Report("compute dispatch", false, "the storage block wasn't found");
+
+	shader.Bind();
+	shader.SetUniform1i("u_Count", (int)itemCount);
+
+	shader.DispatchItems(itemCount);
+
+	// glGetBufferSubData has to see the shader's writes
+	Shader::BufferUpdateBarrier();
+
+	buffer.GetData(values, sizeof(values));
+
+	shader.Unbind();
+
+	for (unsigned int i = 0; i < bufferCount; i++)
+	{
+		unsigned int expected = i < itemCount ? i * 2 + 1 : 0xFFFFFFFF;
+
+		if (values[i] != expected)
+		{
+			std::cout << "Item " << i << " is " << values[i] << ", expected " << expected << std::endl;
+			return Report("compute dispatch", false, "the buffer read back doesn't hold what the shader wrote");
+		}
+	}
+
+	return Report("compute dispatch", true);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Checks that draw or dispatch something offscreen and read the result back, run with --self-check.
+// Nothing is drawn to the window so they work headless, eg with Mesa's llvmpipe on a machine with no GPU.
+// Each check prints what it found and returns whether it passed.
+class SelfCheck
+{
+public:
+
+	// Runs every check, returns how many failed
+	static unsigned int RunAll();
+
+	// An ivec2 attribute fed with GL_INT data reads the values unconverted, and float or normalised data is rejected
+	static bool IntegerAttributes();
+
+	// A compute dispatch over a count that isn't a multiple of the work group size writes exactly those items of a
+	// ShaderStorageBuffer, read back after a barrier. Skipped, and counted as passed, without GL 4.3.
+	static bool ComputeDispatch();
+};
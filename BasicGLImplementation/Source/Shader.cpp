@@ -2,166 +2,916 @@
 #include "Shader.h"
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 #include "GL/glew.h"
 
 #include "Renderer.h"
+#include "Hash.h"
+#include "ShaderCompiler.h"
+#include "ShaderWatcher.h"
+#include "ShaderStorageBuffer.h"
+#include "StateCache.h"
+#include "UniformBuffer.h"
+#include "VertexBufferLayout.h"
+
+ProgramBinaryCache* Shader::s_BinaryCache = nullptr;
+ShaderCompiler* Shader::s_LazyCompiler = nullptr;
+
+// Bound in place of programs that are still being built, it only needs a position at attribute 0
+static const char* s_FallbackShaderSource =
+	"#shader vertex\n"
+	"#version 330 core\n"
+	"layout(location = 0) in vec4 position;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = position;\n"
+	"}\n"
+	"#shader fragment\n"
+	"#version 330 core\n"
+	"layout(location = 0) out vec4 colour;\n"
+	"void main()\n"
+	"{\n"
+	"	colour = vec4(1.0, 0.0, 1.0, 1.0);\n"
+	"}\n";
 
 Shader::Shader(const std::string& filePath)
-	: m_FilePath(filePath), m_RendererID(0)
+	: m_FilePath(filePath), m_RendererID(0), m_SourceHash(0), m_bCompilePending(false), m_pCompiler(nullptr), m_pWatcher(nullptr), m_bCompute(false), m_WorkGroupSize{ 0, 0, 0 }
 {
 	shaderProgSource source = ParseShader(filePath);
-	m_RendererID = CreateShader(source.vertexSource, source.fragmentSource);
+
+	if (source.valid)
+		m_RendererID = CreateShader(source);
+}
+
+Shader::Shader(const std::string& filePath, ShaderCompiler& compiler)
+	: m_FilePath(filePath), m_RendererID(0), m_SourceHash(0), m_bCompilePending(false), m_pCompiler(nullptr), m_pWatcher(nullptr), m_bCompute(false), m_WorkGroupSize{ 0, 0, 0 }
+{
+	shaderProgSource source = ParseShader(filePath);
+
+	if (source.valid)
+		compiler.Submit(*this, source);
+}
+
+Shader::Shader(const std::string& filePath, const shaderProgSource& source, const ShaderDefines& defines)
+	: m_FilePath(filePath), m_RendererID(0), m_Defines(defines.GetPrelude()), m_SourceHash(0), m_bCompilePending(false), m_pCompiler(nullptr), m_pWatcher(nullptr), m_bCompute(false), m_WorkGroupSize{ 0, 0, 0 }
+{
+	if (source.valid)
+		m_RendererID = CreateShader(source);
+}
+
+Shader::Shader(const std::string& filePath, ShaderLoad load)
+	: Shader(filePath, ParseShader(filePath), load)
+{
+}
+
+Shader::Shader(const std::string& filePath, shaderProgSource&& source, ShaderLoad load)
+	: m_FilePath(filePath), m_RendererID(0), m_SourceHash(0), m_bCompilePending(false), m_pCompiler(nullptr), m_pWatcher(nullptr), m_bCompute(false), m_WorkGroupSize{ 0, 0, 0 }
+{
+	if (!source.valid)
+		return;
+
+	if (load == ShaderLoad::Immediate)
+	{
+		m_RendererID = CreateShader(source);
+		return;
+	}
+
+	m_SourceHash = HashShaderSource(source, HashBytes(m_Defines));
+	m_bCompute = source.HasStage(ShaderStage::Compute);
+
+	// Copied out of the mapping, the file can be edited or cut short before the first Bind gets round to compiling it
+	m_DeferredSource = CopyShaderSource(source);
+	m_bCompilePending = true;
 }
 
 Shader::~Shader()
 {
+	// Don't leave the compiler holding a pointer to a deleted shader
+	if (m_pCompiler)
+		m_pCompiler->Cancel(*this);
+
+	if (m_pWatcher)
+		m_pWatcher->Unwatch(*this);
+
+	StateCache::OnProgramDeleted(m_RendererID);
 	GLCall(glDeleteProgram(m_RendererID));
 }
 
 shaderProgSource Shader::ParseShader(const std::string& path)
 {
-	enum class shaderType
+	shaderProgSource source;
+
+	// Builds with EMBED_SHADERS have the file compiled in and already split, so there is nothing to read or parse
+	if (const embeddedShader* embedded = FindEmbeddedShader(path))
+	{
+		for (unsigned int i = 0; i < ShaderStageCount; i++)
+			source.stages[i] = embedded->stages[i];
+
+		source.valid = embedded->valid;
+		return source;
+	}
+
+	// Map the file rather than reading it, the stages are sliced straight out of the mapping
+	source.file = MappedFile(path);
+
+	if (!source.file.IsOpen())
+	{
+		std::cout << "Failed to open shader file " << path << std::endl;
+		return source;
+	}
+
+	ParseShaderSource(source.file.GetContents(), path, source);
+
+	return source;
+}
+
+bool Shader::Reload(const shaderProgSource& source)
+{
+	if (!source.valid)
+		return false;
+
+	// A lazy shader that hasn't been built yet just picks the new file up when it is
+	if (m_bCompilePending)
 	{
-		NONE = -1,
-		VERTEX = 0,
-		FRAGMENT = 1
-	};
+		// The watcher has already parsed the file off the render thread, only the text needs copying
+		m_DeferredSource = CopyShaderSource(source);
+		m_SourceHash = HashShaderSource(m_DeferredSource, HashBytes(m_Defines));
 
-	std::ifstream stream(path);
-	std::string line;
+		return true;
+	}
 
-	std::stringstream streams[2];
+	// A compile of the old source that is still in flight would otherwise overwrite the reloaded program
+	if (m_pCompiler)
+		m_pCompiler->Cancel(*this);
 
-	shaderType type = shaderType::NONE;
+	unsigned int programId = CreateShader(source);
 
-	while (std::getline(stream, line))
+	if (programId == 0)
 	{
-		if (line.find("#shader") != std::string::npos)
-		{
-			if (line.find("vertex") != std::string::npos)
-				type = shaderType::VERTEX;
-			else if (line.find("fragment") != std::string::npos)
-				type = shaderType::FRAGMENT;
-		}
-		else
+		std::cout << "Keeping the previous program for " << m_FilePath << std::endl;
+		return false;
+	}
+
+	// The new program can be given the old one's name once it is deleted, so the state cache has to forget it
+	StateCache::OnProgramDeleted(m_RendererID);
+	GLCall(glDeleteProgram(m_RendererID));
+	m_RendererID = programId;
+
+	return true;
+}
+
+unsigned int Shader::CreateShader(const shaderProgSource& source)
+{
+	pendingProgram pending;
+
+	// Loading from the binary cache finishes the program straight away
+	if (BeginProgram(source, pending))
+		return pending.programId;
+
+	// Run both halves back to back, ShaderCompiler spreads them out so the driver can compile in parallel
+	return FinishProgram(pending);
+}
+
+bool Shader::BeginProgram(const shaderProgSource& source, pendingProgram& pending)
+{
+	pending = { this, 0, {}, 0 };
+
+	m_SourceHash = HashShaderSource(source, HashBytes(m_Defines));
+
+	// Try the on disk program binary cache before going anywhere near the GLSL compiler
+	if (s_BinaryCache)
+	{
+		pending.binaryKey = s_BinaryCache->MakeKey(source, m_Defines);
+
+		unsigned int cachedProgramId = s_BinaryCache->Load(pending.binaryKey);
+
+		if (cachedProgramId != 0)
 		{
-			streams[(int)type] << line << '\n';
+			OnProgramLinked(cachedProgramId, source.HasStage(ShaderStage::Compute));
+			pending.programId = cachedProgramId;
+			return true;
 		}
 	}
 
-	return { streams[0].str(), streams[1].str() };
+	// Create the program object that will house the shader stages
+	pending.programId = glCreateProgram();
+
+	// Use CompileShaderStage to create a shader for every stage in the file and attach it to the program object
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (!source.HasStage((ShaderStage)i))
+			continue;
+
+		pending.shaderIds[i] = CompileShaderStage((ShaderStage)i, source.stages[i], m_Defines);
+
+		GLCall(glAttachShader(pending.programId, pending.shaderIds[i]));
+	}
+
+	// Ask the driver to keep the program binary around so it can be written to the cache after linking
+	if (s_BinaryCache && s_BinaryCache->IsSupported())
+	{
+		GLCall(glProgramParameteri(pending.programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
+
+	// Link the program (ie link the shader stages together)
+	// Nothing has queried a status yet so the driver is free to still be compiling when this returns
+	GLCall(glLinkProgram(pending.programId));
+
+	return false;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::FinishProgram(pendingProgram& pending)
 {
-	// Create the program object that will house the vertex/fragment shaders
-	unsigned int programId = glCreateProgram();
+	unsigned int programId = pending.programId;
+
+	// Querying the status from here on waits for the driver to finish compiling and linking
+	bool compiled = true;
+
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (pending.shaderIds[i] != 0)
+			compiled = CheckShaderStageCompiled(pending.shaderIds[i], (ShaderStage)i, m_FilePath) && compiled;
+	}
 
-	// Use CompileShader function to create the vertex/fragment shaders
-	unsigned int vShaderId = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fShaderId = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	// Create int to hold program query return value
+	int program_linked;
 
-	// Attach the shaders to the program object
-	GLCall(glAttachShader(programId, vShaderId));
-	GLCall(glAttachShader(programId, fShaderId));
+	GLCall(glGetProgramiv(programId, GL_LINK_STATUS, &program_linked));
 
-	// Link the program (ie link the vertex and fragment shaders)
-	GLCall(glLinkProgram(programId));
+	int program_valid = GL_FALSE;
 
-	// Validate the program object (ie is it possible to execute the program)
-	GLCall(glValidateProgram(programId));
+	if (compiled && program_linked == GL_TRUE)
+	{
+		// Validate the program object (ie is it possible to execute the program)
+		GLCall(glValidateProgram(programId));
 
-	// Create int to hold program query return value
-	int program_compiled;
+		GLCall(glGetProgramiv(programId, GL_VALIDATE_STATUS, &program_valid));
+	}
 
-	// Get shader value based on flag sent as arg (for this cal was GL_COMPILE_STATUS)
-	GLCall(glGetProgramiv(programId, GL_VALIDATE_STATUS, &program_compiled));
+	for (unsigned int shaderId : pending.shaderIds)
+	{
+		if (shaderId != 0)
+		{
+			GLCall(glDeleteShader(shaderId));
+		}
+	}
 
-	// if the compilation status is not GL_TRUE (if the compile failed)
-	if (program_compiled != GL_TRUE)
+	// if linking or validation failed
+	if (program_valid != GL_TRUE)
 	{
-		// Get the message from the shader log
+		// Get the message from the program log
 		GLsizei log_length = 0;
-		GLchar message[1024];
-		GLCall(glGetShaderInfoLog(programId, 1024, &log_length, message));
+		GLchar message[1024] = "";
+		GLCall(glGetProgramInfoLog(programId, 1024, &log_length, message));
 
-		std::cout << "Failed to validate shader program, message: " << message << std::endl;
+		std::cout << "Failed to " << (program_linked == GL_TRUE ? "validate" : "link") << " shader program " << m_FilePath << ", message: " << message << std::endl;
 
-		GLCall(glDeleteShader(vShaderId));
-		GLCall(glDeleteShader(fShaderId));
 		GLCall(glDeleteProgram(programId));
 
 		return 0;
 	}
 
-	GLCall(glDeleteShader(vShaderId));
-	GLCall(glDeleteShader(fShaderId));
+	OnProgramLinked(programId, pending.shaderIds[(int)ShaderStage::Compute] != 0);
+
+	if (s_BinaryCache)
+		s_BinaryCache->Store(pending.binaryKey, programId);
 
 	return programId;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& src)
+void Shader::Warmup(ShaderCompiler& compiler)
 {
-	// Create the shader id 
-	unsigned int shaderId = glCreateShader(type);
+	if (!m_bCompilePending)
+		return;
 
-	// convert the source string to a const char pointer because that is what glShaderSource needs
-	const char* source = src.c_str();
+	m_bCompilePending = false;
 
-	// Set the sharder source code using the provided const char pointer 
-	GLCall(glShaderSource(shaderId, 1, &source, nullptr));
+	shaderProgSource source = std::move(m_DeferredSource);
+	compiler.Submit(*this, source);
+}
 
-	// Compile the shader scource code
-	GLCall(glCompileShader(shaderId));
+void Shader::CompileDeferred(bool wait)
+{
+	if (m_bCompilePending)
+	{
+		m_bCompilePending = false;
+
+		// The source isn't needed once the stages have been handed to the driver
+		shaderProgSource source = std::move(m_DeferredSource);
 
-	// Create int to hold shader query return value
-	int shader_compiled;
+		if (s_LazyCompiler && !wait)
+			s_LazyCompiler->Submit(*this, source);
+		else
+			m_RendererID = CreateShader(source);
+	}
 
-	// Get shader value based on flag sent as arg (for this cal was GL_COMPILE_STATUS)
-	GLCall(glGetShaderiv(shaderId, GL_COMPILE_STATUS, &shader_compiled));
+	if (wait && m_pCompiler)
+		m_pCompiler->Wait(*this);
+}
 
-	// if the compilation status is not GL_TRUE (if the compile failed)
-	if (shader_compiled != GL_TRUE)
+unsigned int Shader::GetFallbackProgram()
+{
+	// Built the first time it is needed and never deleted, the GL context is gone by the time statics are destroyed
+	static Shader* s_pFallback = nullptr;
+
+	if (!s_pFallback)
 	{
-		// Get the message from the shader log
-		GLsizei log_length = 0;
-		GLchar message[1024];
-		GLCall(glGetShaderInfoLog(shaderId, 1024, &log_length, message));
+		shaderProgSource source;
+		ParseShaderSource(s_FallbackShaderSource, "Fallback", source);
+
+		s_pFallback = new Shader("Fallback", source, ShaderDefines());
+	}
 
-		std::cout << "Failed to compile" << (type == GL_VERTEX_SHADER ? " vertex " : " fragment ") << "shader, message: " << message << std::endl;
+	return s_pFallback->m_RendererID;
+}
 
-		GLCall(glDeleteShader(shaderId));
+void Shader::OnProgramLinked(unsigned int programId, bool compute)
+{
+	m_bCompute = compute;
 
-		return 0;
+	// The group size is fixed by the local_size layout in the shader, read it back for DispatchItems
+	if (compute)
+	{
+		int workGroupSize[3] = { 0, 0, 0 };
+		GLCall(glGetProgramiv(programId, GL_COMPUTE_WORK_GROUP_SIZE, workGroupSize));
+
+		for (int i = 0; i < 3; i++)
+			m_WorkGroupSize[i] = (unsigned int)workGroupSize[i];
+	}
+	else
+	{
+		m_WorkGroupSize[0] = m_WorkGroupSize[1] = m_WorkGroupSize[2] = 0;
+	}
+
+	// Read back every active uniform now so uniform lookups never have to go to the driver
+	m_UniformCache.Build(programId);
+
+	ApplyDeferredUniforms(programId);
+
+	m_vAttributes.clear();
+	m_vLayoutChecks.clear();
+
+	int attributeCount = 0;
+	int maxNameLength = 0;
+
+	GLCall(glGetProgramiv(programId, GL_ACTIVE_ATTRIBUTES, &attributeCount));
+	GLCall(glGetProgramiv(programId, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength));
+
+	std::vector<char> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+
+	for (int i = 0; i < attributeCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+
+		GLCall(glGetActiveAttrib(programId, i, (GLsizei)nameBuffer.size(), &nameLength, &size, &type, nameBuffer.data()));
+		GLCall(int location = glGetAttribLocation(programId, nameBuffer.data()));
+
+		// Built in inputs like gl_VertexID are active but have no location
+		if (location != -1)
+			m_vAttributes.push_back({ std::string(nameBuffer.data(), nameLength), location, type, size });
+	}
+
+	// Block bindings are program state so a rebuilt program has to be linked to its buffers again
+	for (const auto& blockBinding : m_vBlockBindings)
+	{
+		const uniformBlockInfo* block = m_UniformCache.FindBlock(blockBinding.first);
+
+		if (block)
+		{
+			GLCall(glUniformBlockBinding(programId, block->index, blockBinding.second));
+		}
+	}
+
+	for (const auto& storageBinding : m_vStorageBindings)
+	{
+		GLCall(unsigned int blockIndex = glGetProgramResourceIndex(programId, GL_SHADER_STORAGE_BLOCK, storageBinding.first.c_str()));
+
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			GLCall(glShaderStorageBlockBinding(programId, blockIndex, storageBinding.second));
+		}
+	}
+}
+
+int Shader::GetAttributeLocation(std::string_view attributeName) const
+{
+	for (const attributeInfo& attribute : m_vAttributes)
+	{
+		if (attribute.name == attributeName)
+			return attribute.location;
+	}
+
+	return -1;
+}
+
+// Whether an attribute of this type is read as integers, these have to be fed with glVertexAttribIPointer (see VertexBufferElement::IsInteger)
+static bool IsIntegerAttributeType(unsigned int type)
+{
+	switch (type)
+	{
+	case GL_INT:
+	case GL_INT_VEC2:
+	case GL_INT_VEC3:
+	case GL_INT_VEC4:
+	case GL_UNSIGNED_INT:
+	case GL_UNSIGNED_INT_VEC2:
+	case GL_UNSIGNED_INT_VEC3:
+	case GL_UNSIGNED_INT_VEC4:
+		return true;
+	}
+
+	return false;
+}
+
+bool Shader::IsCompatible(const VertexBufferLayout& layout)
+{
+	CompileDeferred(true);
+
+	// Only the first check of each layout does any work
+	for (const auto& layoutCheck : m_vLayoutChecks)
+	{
+		if (layoutCheck.first == layout.GetHash())
+			return layoutCheck.second;
+	}
+
+	const auto& elements = layout.GetElements();
+	bool compatible = true;
+
+	for (const attributeInfo& attribute : m_vAttributes)
+	{
+		const VertexBufferElement* feedingElement = nullptr;
+
+		// Named elements feed the attribute with that name, unnamed ones the attribute at their index
+		for (unsigned int i = 0; i < elements.size() && !feedingElement; i++)
+		{
+			if (elements[i].name.empty() ? attribute.location == (int)i : elements[i].name == attribute.name)
+				feedingElement = &elements[i];
+		}
+
+		if (!feedingElement)
+		{
+			std::cout << "Shader " << m_FilePath << " reads attribute " << attribute.name << " (location " << attribute.location << ") but the vertex layout doesn't provide it" << std::endl;
+			compatible = false;
+		}
+		else if (IsIntegerAttributeType(attribute.type) && !feedingElement->IsInteger())
+		{
+			// Includes normalised integer data, which GL converts to float before the shader sees it
+			std::cout << "Shader " << m_FilePath << " reads integer attribute " << attribute.name << " from " << (feedingElement->type == GL_FLOAT ? "float" : "normalised") << " vertex data" << std::endl;
+			compatible = false;
+		}
+		else if (!IsIntegerAttributeType(attribute.type) && feedingElement->IsInteger())
+		{
+			std::cout << "Shader " << m_FilePath << " reads float attribute " << attribute.name << " from integer vertex data, push it normalised or as floats" << std::endl;
+			compatible = false;
+		}
+	}
+
+	m_vLayoutChecks.push_back({ layout.GetHash(), compatible });
+
+	return compatible;
+}
+
+bool Shader::BindUniformBlock(std::string_view blockName, const UniformBuffer& buffer)
+{
+	const uniformBlockInfo* block = m_UniformCache.FindBlock(blockName);
+
+	if (!block)
+	{
+		std::cout << "Uniform block " << blockName << " doesn't exist in " << m_FilePath << std::endl;
+		return false;
+	}
+
+	// The CPU struct has to cover the whole block, a smaller one means the two layouts don't match
+	if ((int)buffer.GetSize() < block->dataSize)
+		std::cout << "Uniform block " << blockName << " is " << block->dataSize << " bytes but its buffer is only " << buffer.GetSize() << std::endl;
+
+	GLCall(glUniformBlockBinding(m_RendererID, block->index, buffer.GetBinding()));
+
+	bool known = false;
+
+	for (auto& blockBinding : m_vBlockBindings)
+	{
+		if (blockBinding.first == blockName)
+		{
+			blockBinding.second = buffer.GetBinding();
+			known = true;
+		}
+	}
+
+	if (!known)
+		m_vBlockBindings.push_back({ std::string(blockName), buffer.GetBinding() });
+
+	return true;
+}
+
+bool Shader::BindStorageBlock(std::string_view blockName, const ShaderStorageBuffer& buffer)
+{
+	std::string name(blockName);
+
+	// Storage blocks are only reflected through the 4.3 program interface queries, this is a setup time call so ask the driver
+	GLCall(unsigned int blockIndex = glGetProgramResourceIndex(m_RendererID, GL_SHADER_STORAGE_BLOCK, name.c_str()));
+
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		std::cout << "Shader storage block " << blockName << " doesn't exist in " << m_FilePath << std::endl;
+		return false;
+	}
+
+	GLCall(glShaderStorageBlockBinding(m_RendererID, blockIndex, buffer.GetBinding()));
+
+	bool known = false;
+
+	for (auto& storageBinding : m_vStorageBindings)
+	{
+		if (storageBinding.first == blockName)
+		{
+			storageBinding.second = buffer.GetBinding();
+			known = true;
+		}
+	}
+
+	if (!known)
+		m_vStorageBindings.push_back({ std::move(name), buffer.GetBinding() });
+
+	return true;
+}
+
+bool Shader::IsComputeSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+}
+
+void Shader::Dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ)
+{
+	if (!m_bCompute)
+	{
+		std::cout << "Can't dispatch " << m_FilePath << ", it isn't a compute program" << std::endl;
+		return;
+	}
+
+	Bind();
+
+	// Still compiling
+	if (!IsReady())
+		return;
+
+	GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+}
+
+void Shader::DispatchItems(unsigned int itemsX, unsigned int itemsY, unsigned int itemsZ)
+{
+	if (!m_bCompute)
+	{
+		std::cout << "Can't dispatch " << m_FilePath << ", it isn't a compute program" << std::endl;
+		return;
+	}
+
+	// The work group size is only known once the program is built
+	if (m_bCompilePending)
+		CompileDeferred(false);
+
+	if (!IsReady())
+		return;
+
+	// Round up so the last partial group still runs, the shader has to skip invocations past the end itself
+	Dispatch((itemsX + m_WorkGroupSize[0] - 1) / m_WorkGroupSize[0],
+		(itemsY + m_WorkGroupSize[1] - 1) / m_WorkGroupSize[1],
+		(itemsZ + m_WorkGroupSize[2] - 1) / m_WorkGroupSize[2]);
+}
+
+void Shader::DispatchIndirect(const ShaderStorageBuffer& arguments, unsigned int offset)
+{
+	if (!m_bCompute)
+	{
+		std::cout << "Can't dispatch " << m_FilePath << ", it isn't a compute program" << std::endl;
+		return;
 	}
 
-	return shaderId;
+	// The arguments are read from whatever is bound to GL_DISPATCH_INDIRECT_BUFFER, the offset has to be 4 byte aligned
+	ASSERT(offset % 4 == 0 && offset + 3 * sizeof(unsigned int) <= arguments.GetSize());
+
+	Bind();
+
+	if (!IsReady())
+		return;
+
+	GLCall(glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, arguments.GetRendererId()));
+	GLCall(glDispatchComputeIndirect((GLintptr)offset));
+}
+
+void Shader::StorageBarrier()
+{
+	Barrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Shader::VertexDataBarrier()
+{
+	Barrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT);
+}
+
+void Shader::CommandBarrier()
+{
+	Barrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void Shader::UniformBarrier()
+{
+	Barrier(GL_UNIFORM_BARRIER_BIT);
+}
+
+void Shader::BufferUpdateBarrier()
+{
+	Barrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void Shader::Barrier(unsigned int barrierBits)
+{
+	GLCall(glMemoryBarrier(barrierBits));
 }
 
-void Shader::Bind() const
+void Shader::Bind()
 {
-	GLCall(glUseProgram(m_RendererID));
+	if (m_bCompilePending)
+		CompileDeferred(false);
+
+	// Draw with the fallback while the program is being built (or if it failed) so the object still shows up.
+	// Compute programs have nothing to fall back to, Dispatch skips them until they are ready.
+	if (!IsReady() && !m_bCompute)
+	{
+		StateCache::UseProgram(GetFallbackProgram());
+		return;
+	}
+
+	// Skipped if the program is already in use
+	StateCache::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-	GLCall(glUseProgram(0));
+	StateCache::UseProgram(0);
+}
+
+void Shader::SetUniform1f(std::string_view uniformName, float v)
+{
+	float values[1] = { v };
+
+	SetUniformValue(uniformName, uniformCall::Float1, 1, values);
+}
+
+void Shader::SetUniform1f(UniformId uniform, float v)
+{
+	float values[1] = { v };
+
+	SetUniformValue(uniform, uniformCall::Float1, 1, values);
+}
+
+void Shader::SetUniform2f(std::string_view uniformName, float v1, float v2)
+{
+	float values[2] = { v1, v2 };
+
+	SetUniformValue(uniformName, uniformCall::Float2, 1, values);
+}
+
+void Shader::SetUniform2f(UniformId uniform, float v1, float v2)
+{
+	float values[2] = { v1, v2 };
+
+	SetUniformValue(uniform, uniformCall::Float2, 1, values);
+}
+
+void Shader::SetUniform3f(std::string_view uniformName, float v1, float v2, float v3)
+{
+	float values[3] = { v1, v2, v3 };
+
+	SetUniformValue(uniformName, uniformCall::Float3, 1, values);
+}
+
+void Shader::SetUniform3f(UniformId uniform, float v1, float v2, float v3)
+{
+	float values[3] = { v1, v2, v3 };
+
+	SetUniformValue(uniform, uniformCall::Float3, 1, values);
+}
+
+void Shader::SetUniform4f(std::string_view uniformName, float v1, float v2, float v3, float v4)
+{
+	float values[4] = { v1, v2, v3, v4 };
+
+	SetUniformValue(uniformName, uniformCall::Float4, 1, values);
+}
+
+void Shader::SetUniform4f(UniformId uniform, float v1, float v2, float v3, float v4)
+{
+	float values[4] = { v1, v2, v3, v4 };
+
+	SetUniformValue(uniform, uniformCall::Float4, 1, values);
+}
+
+void Shader::SetUniform1i(std::string_view uniformName, int v)
+{
+	int values[1] = { v };
+
+	SetUniformValue(uniformName, uniformCall::Int1, 1, values);
+}
+
+void Shader::SetUniform1i(UniformId uniform, int v)
+{
+	int values[1] = { v };
+
+	SetUniformValue(uniform, uniformCall::Int1, 1, values);
+}
+
+void Shader::SetUniformMat3f(std::string_view uniformName, const float* matrix)
+{
+	SetUniformValue(uniformName, uniformCall::Mat3, 1, matrix);
+}
+
+void Shader::SetUniformMat3f(UniformId uniform, const float* matrix)
+{
+	SetUniformValue(uniform, uniformCall::Mat3, 1, matrix);
+}
+
+void Shader::SetUniformMat4f(std::string_view uniformName, const float* matrix)
+{
+	SetUniformValue(uniformName, uniformCall::Mat4, 1, matrix);
+}
+
+void Shader::SetUniformMat4f(UniformId uniform, const float* matrix)
+{
+	SetUniformValue(uniform, uniformCall::Mat4, 1, matrix);
+}
+
+void Shader::SetUniform1fv(std::string_view uniformName, unsigned int count, const float* values)
+{
+	SetUniformValue(uniformName, uniformCall::Float1, count, values);
+}
+
+void Shader::SetUniform1fv(UniformId uniform, unsigned int count, const float* values)
+{
+	SetUniformValue(uniform, uniformCall::Float1, count, values);
+}
+
+void Shader::SetUniform2fv(std::string_view uniformName, unsigned int count, const float* values)
+{
+	SetUniformValue(uniformName, uniformCall::Float2, count, values);
+}
+
+void Shader::SetUniform2fv(UniformId uniform, unsigned int count, const float* values)
+{
+	SetUniformValue(uniform, uniformCall::Float2, count, values);
+}
+
+void Shader::SetUniform3fv(std::string_view uniformName, unsigned int count, const float* values)
+{
+	SetUniformValue(uniformName, uniformCall::Float3, count, values);
+}
+
+void Shader::SetUniform3fv(UniformId uniform, unsigned int count, const float* values)
+{
+	SetUniformValue(uniform, uniformCall::Float3, count, values);
+}
+
+void Shader::SetUniform4fv(std::string_view uniformName, unsigned int count, const float* values)
+{
+	SetUniformValue(uniformName, uniformCall::Float4, count, values);
+}
+
+void Shader::SetUniform4fv(UniformId uniform, unsigned int count, const float* values)
+{
+	SetUniformValue(uniform, uniformCall::Float4, count, values);
+}
+
+void Shader::SetUniform1iv(std::string_view uniformName, unsigned int count, const int* values)
+{
+	SetUniformValue(uniformName, uniformCall::Int1, count, values);
+}
+
+void Shader::SetUniform1iv(UniformId uniform, unsigned int count, const int* values)
+{
+	SetUniformValue(uniform, uniformCall::Int1, count, values);
+}
+
+void Shader::SetUniformMat4fv(std::string_view uniformName, unsigned int count, const float* matrices)
+{
+	SetUniformValue(uniformName, uniformCall::Mat4, count, matrices);
 }
 
-void Shader::SetUniform4f(const std::string& uniformName, float v1, float v2, float v3, float v4)
+void Shader::SetUniformMat4fv(UniformId uniform, unsigned int count, const float* matrices)
 {
-	GLCall(glUniform4f(GetUniformLocation(uniformName), v1, v2, v3, v4));
+	SetUniformValue(uniform, uniformCall::Mat4, count, matrices);
 }
 
-int Shader::GetUniformLocation(const std::string& uniformName)
+void Shader::SetUniformValue(const uniformInfo* uniform, uniformCall call, unsigned int count, const void* data)
 {
-	GLCall(int location = glGetUniformLocation(m_RendererID, uniformName.c_str()));
+	if (!uniform)
+		return;
 
-	if (location == -1)
+	// Nothing to do if the program already has this value
+	if (!m_UniformCache.Update(*uniform, data, s_UniformCallSizes[(int)call] * count))
+		return;
+
+	const float* floats = (const float*)data;
+
+	switch (call)
+	{
+	case uniformCall::Float1:	GLCall(glUniform1fv(uniform->location, count, floats)); break;
+	case uniformCall::Float2:	GLCall(glUniform2fv(uniform->location, count, floats)); break;
+	case uniformCall::Float3:	GLCall(glUniform3fv(uniform->location, count, floats)); break;
+	case uniformCall::Float4:	GLCall(glUniform4fv(uniform->location, count, floats)); break;
+	case uniformCall::Int1:		GLCall(glUniform1iv(uniform->location, count, (const int*)data)); break;
+	case uniformCall::Mat3:		GLCall(glUniformMatrix3fv(uniform->location, count, GL_FALSE, floats)); break;
+	case uniformCall::Mat4:		GLCall(glUniformMatrix4fv(uniform->location, count, GL_FALSE, floats)); break;
+	case uniformCall::Count:	break;
+	}
+}
+
+void Shader::SetUniformValue(std::string_view uniformName, uniformCall call, unsigned int count, const void* data)
+{
+	// The fallback program is bound and has none of these uniforms, the value waits for the real program
+	if (!IsReady())
+	{
+		DeferUniformValue(uniformName, call, count, data);
+		return;
+	}
+
+	SetUniformValue(FindUniform(uniformName), call, count, data);
+}
+
+void Shader::SetUniformValue(UniformId uniform, uniformCall call, unsigned int count, const void* data)
+{
+	if (!IsReady())
+	{
+		DeferUniformValue(uniform.name, call, count, data);
+		return;
+	}
+
+	SetUniformValue(FindUniform(uniform), call, count, data);
+}
+
+void Shader::DeferUniformValue(std::string_view uniformName, uniformCall call, unsigned int count, const void* data)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned int size = s_UniformCallSizes[(int)call] * count;
+
+	// Only the last value matters, set once values like sampler units are the ones that must not be lost
+	for (deferredUniform& deferred : m_vDeferredUniforms)
+	{
+		if (deferred.name == uniformName)
+		{
+			deferred.call = call;
+			deferred.count = count;
+			deferred.value.assign(bytes, bytes + size);
+			return;
+		}
+	}
+
+	m_vDeferredUniforms.push_back({ std::string(uniformName), call, count, std::vector<unsigned char>(bytes, bytes + size) });
+}
+
+void Shader::ApplyDeferredUniforms(unsigned int programId)
+{
+	if (m_vDeferredUniforms.empty())
+		return;
+
+	// glUniform* sets the bound program, put back whatever was bound before
+	unsigned int previousProgram = StateCache::GetProgram();
+	StateCache::UseProgram(programId);
+
+	for (const deferredUniform& deferred : m_vDeferredUniforms)
+	{
+		const uniformInfo* uniform = m_UniformCache.Find(deferred.name);
+
+		if (uniform)
+			SetUniformValue(uniform, deferred.call, deferred.count, deferred.value.data());
+		else
+			std::cout << "Uniform " << deferred.name << " doesn't exist" << std::endl;
+	}
+
+	m_vDeferredUniforms.clear();
+
+	if (previousProgram != StateCache::Unknown)
+		StateCache::UseProgram(previousProgram);
+}
+
+const uniformInfo* Shader::FindUniform(std::string_view uniformName)
+{
+	// Look the uniform up in the table built at link time rather than calling glGetUniformLocation
+	const uniformInfo* uniform = m_UniformCache.Find(uniformName);
+
+	if (!uniform)
 		std::cout << "Uniform " << uniformName << " doesn't exist" << std::endl;
-	
-	return location;
+
+	return uniform;
+}
+
+const uniformInfo* Shader::FindUniform(UniformId uniform)
+{
+	const uniformInfo* info = m_UniformCache.Find(uniform);
+
+	if (!info)
+		std::cout << "Uniform " << uniform.name << " doesn't exist" << std::endl;
+
+	return info;
 }
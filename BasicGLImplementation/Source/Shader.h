@@ -1,11 +1,44 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 
-struct shaderProgSource
+#include "UniformCache.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderSource.h"
+
+class Shader;
+class ShaderCompiler;
+class ShaderWatcher;
+class UniformBuffer;
+class ShaderStorageBuffer;
+class VertexBufferLayout;
+
+// Details of one active vertex attribute, read back from the program once it has been linked
+struct attributeInfo
+{
+	std::string		name;
+	int				location;
+	unsigned int	type;
+	int				size;
+};
+
+// A program that has been submitted to the driver but whose compile/link status hasn't been queried yet
+struct pendingProgram
 {
-	std::string vertexSource;
-	std::string fragmentSource;
+	Shader*				shader;
+	unsigned int		programId;
+	unsigned int		shaderIds[ShaderStageCount];
+	unsigned long long	binaryKey;
+};
+
+// Immediate programs are compiled by the constructor, Lazy ones only parse and hash their source there
+// and compile the first time they are bound (or earlier if Warmup is called)
+enum class ShaderLoad
+{
+	Immediate,
+	Lazy
 };
 
 class Shader 
@@ -13,26 +46,249 @@ class Shader
 
 public:
 	Shader(const std::string& filePath);
+
+	// Submit the program to a ShaderCompiler batch instead of waiting for it to compile, check IsReady before use
+	Shader(const std::string& filePath, ShaderCompiler& compiler);
+
+	// Build a variant of an already parsed file with the defines injected into every stage
+	Shader(const std::string& filePath, const shaderProgSource& source, const ShaderDefines& defines);
+
+	// Only parse and hash the file now, the program is built on first Bind (or by Warmup) and the fallback program is bound until then
+	Shader(const std::string& filePath, ShaderLoad load);
+
+	// Same again for a file that has already been parsed, the source is kept by lazy shaders until they are built
+	Shader(const std::string& filePath, shaderProgSource&& source, ShaderLoad load);
+
 	~Shader();
 
-	void Bind() const;
+	// Map and split a shader file, safe to call from any thread
+	static shaderProgSource ParseShader(const std::string& path);
+
+	// Build a new program from the source and swap it in, the current program is kept if the new one fails
+	bool Reload(const shaderProgSource& source);
+
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+
+	// Hash of the stage sources and injected defines
+	inline unsigned long long GetSourceHash() const { return m_SourceHash; }
+
+	// Whether this is a lazy shader that hasn't started building its program yet
+	inline bool IsCompilePending() const { return m_bCompilePending; }
+
+	// Start building a lazy shader's program now, in the given compiler's batch, instead of waiting for the first Bind
+	void Warmup(ShaderCompiler& compiler);
+
+	// Lazy shaders bound for the first time are submitted to this compiler rather than compiled on the spot,
+	// pass nullptr to compile them inside Bind. Must outlive every shader submitted to it.
+	static void SetLazyCompiler(ShaderCompiler* compiler) { s_LazyCompiler = compiler; }
+
+	// The program in use, 0 until it has been built
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	inline bool IsCompiling() const { return m_pCompiler != nullptr; }
+	inline bool IsReady() const { return m_pCompiler == nullptr && m_RendererID != 0; }
+
+	// Whether the program is a single '#shader compute' stage, which is run with Dispatch rather than drawn
+	inline bool IsCompute() const { return m_bCompute; }
+
+	// Binds the fallback program instead if the program isn't ready yet, and starts building it if this is a lazy shader.
+	// Uniforms set in the meantime are kept and uploaded to the program once it has been linked.
+	void Bind();
 	void Unbind() const;
 
-	void SetUniform4f(const std::string& uniformName, float v1, float v2, float v3, float v4);
+	// Programs created after this is set are loaded from/stored to the cache, pass nullptr to always compile
+	static void SetProgramBinaryCache(ProgramBinaryCache* cache) { s_BinaryCache = cache; }
+
+	// Location of an active attribute, -1 if the program has no such attribute. Uses the reflected attributes, not the driver.
+	int GetAttributeLocation(std::string_view attributeName) const;
+
+	// Whether a vertex buffer with this layout provides every attribute the program reads.
+	// The check is done once per layout and the result remembered, problems are printed the first time.
+	// This needs the real attributes so a lazy or still compiling program is finished first.
+	bool IsCompatible(const VertexBufferLayout& layout);
+
+	inline const std::vector<attributeInfo>& GetAttributes() const { return m_vAttributes; }
+	inline const std::vector<uniformInfo>& GetUniforms() const { return m_UniformCache.GetUniforms(); }
+
+	// Link a uniform block to the buffer's binding point, this is kept across hot reloads
+	bool BindUniformBlock(std::string_view blockName, const UniformBuffer& buffer);
+
+	// Link a shader storage block to the buffer's binding point, this is kept across hot reloads
+	bool BindStorageBlock(std::string_view blockName, const ShaderStorageBuffer& buffer);
+
+	// Compute shaders need GL 4.3 or ARB_compute_shader (Mesa's llvmpipe provides both)
+	static bool IsComputeSupported();
+
+	// Bind the compute program and run the given number of work groups
+	void Dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1);
+
+	// Run enough work groups to cover the item counts, rounding up by the local_size declared in the shader
+	void DispatchItems(unsigned int itemsX, unsigned int itemsY = 1, unsigned int itemsZ = 1);
+
+	// Run the work group counts stored as three uints at the offset in the buffer, so an earlier dispatch can decide how much work there is
+	void DispatchIndirect(const ShaderStorageBuffer& arguments, unsigned int offset = 0);
+
+	inline const unsigned int* GetWorkGroupSize() const { return m_WorkGroupSize; }
+
+	// Writes made by a dispatch aren't visible to later GL commands until a barrier covering the way they are read.
+	// Call these between the dispatch and whatever consumes its results.
+	static void StorageBarrier();		// read by later dispatches or shaders through storage blocks
+	static void VertexDataBarrier();	// read as vertex attributes or indices
+	static void CommandBarrier();		// read as indirect dispatch or draw arguments
+	static void UniformBarrier();		// read through uniform blocks
+	static void BufferUpdateBarrier();	// read back or updated from the CPU with glGetBufferSubData/glMapBuffer etc.
+	static void Barrier(unsigned int barrierBits);
+
+	// Typed uniform setters, the shader must be bound. Each value is compared with the last one set on this program
+	// and the GL call is skipped if it hasn't changed. Matrices are column major, the array setters start at element 0.
+	void SetUniform1f(std::string_view uniformName, float v);
+	void SetUniform1f(UniformId uniform, float v);
+
+	void SetUniform2f(std::string_view uniformName, float v1, float v2);
+	void SetUniform2f(UniformId uniform, float v1, float v2);
+
+	void SetUniform3f(std::string_view uniformName, float v1, float v2, float v3);
+	void SetUniform3f(UniformId uniform, float v1, float v2, float v3);
+
+	void SetUniform4f(std::string_view uniformName, float v1, float v2, float v3, float v4);
+	void SetUniform4f(UniformId uniform, float v1, float v2, float v3, float v4);
+
+	void SetUniform1i(std::string_view uniformName, int v);
+	void SetUniform1i(UniformId uniform, int v);
+
+	void SetUniformMat3f(std::string_view uniformName, const float* matrix);
+	void SetUniformMat3f(UniformId uniform, const float* matrix);
+
+	void SetUniformMat4f(std::string_view uniformName, const float* matrix);
+	void SetUniformMat4f(UniformId uniform, const float* matrix);
+
+	void SetUniform1fv(std::string_view uniformName, unsigned int count, const float* values);
+	void SetUniform1fv(UniformId uniform, unsigned int count, const float* values);
+
+	void SetUniform2fv(std::string_view uniformName, unsigned int count, const float* values);
+	void SetUniform2fv(UniformId uniform, unsigned int count, const float* values);
+
+	void SetUniform3fv(std::string_view uniformName, unsigned int count, const float* values);
+	void SetUniform3fv(UniformId uniform, unsigned int count, const float* values);
+
+	void SetUniform4fv(std::string_view uniformName, unsigned int count, const float* values);
+	void SetUniform4fv(UniformId uniform, unsigned int count, const float* values);
+
+	void SetUniform1iv(std::string_view uniformName, unsigned int count, const int* values);
+	void SetUniform1iv(UniformId uniform, unsigned int count, const int* values);
+
+	void SetUniformMat4fv(std::string_view uniformName, unsigned int count, const float* matrices);
+	void SetUniformMat4fv(UniformId uniform, unsigned int count, const float* matrices);
+
+	// How many uniform uploads went to the driver and how many were skipped because the value hadn't changed
+	inline unsigned int GetUniformUploadsIssued() const { return m_UniformCache.GetUploadsIssued(); }
+	inline unsigned int GetUniformUploadsSkipped() const { return m_UniformCache.GetUploadsSkipped(); }
 
 private:
-	shaderProgSource ParseShader(const std::string& path);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int CompileShader(unsigned int type, const std::string& src);
+	friend class ShaderCompiler;
+	friend class ShaderWatcher;
+
+	unsigned int CreateShader(const shaderProgSource& source);
+
+	// Returns true if the program is already finished (loaded from the binary cache)
+	bool BeginProgram(const shaderProgSource& source, pendingProgram& pending);
+
+	// Waits for the driver if it is still compiling, returns 0 if the program failed
+	unsigned int FinishProgram(pendingProgram& pending);
+
+	// Build the program of a lazy shader, in s_LazyCompiler's batch unless wait is set or there is no compiler.
+	// With wait set a program already in a compiler batch is finished as well.
+	void CompileDeferred(bool wait);
+
+	// Flat colour program drawn with while a program is still being built
+	static unsigned int GetFallbackProgram();
+
+	// Reflect the new program and restore the state that belongs to the Shader rather than the program
+	void OnProgramLinked(unsigned int programId, bool compute);
+
+	enum class uniformCall
+	{
+		Float1,
+		Float2,
+		Float3,
+		Float4,
+		Int1,
+		Mat3,
+		Mat4,
 
-	int GetUniformLocation(const std::string& uniformName);
+		Count	// Number of calls above, not a call itself
+	};
+
+	// Bytes in one element for each kind of call, in uniformCall order
+	static constexpr unsigned int s_UniformCallSizes[] = { 4, 8, 12, 16, 4, 36, 64 };
+
+	static_assert(sizeof(s_UniformCallSizes) / sizeof(s_UniformCallSizes[0]) == (unsigned int)uniformCall::Count,
+		"s_UniformCallSizes needs a size for every uniformCall");
+
+	// A uniform set before the program was ready, applied once it has been linked
+	struct deferredUniform
+	{
+		std::string					name;
+		uniformCall					call;
+		unsigned int				count;
+		std::vector<unsigned char>	value;
+	};
+
+	void SetUniformValue(const uniformInfo* uniform, uniformCall call, unsigned int count, const void* data);
+
+	// Set the value now, or keep it for OnProgramLinked while the fallback program stands in for this one
+	void SetUniformValue(std::string_view uniformName, uniformCall call, unsigned int count, const void* data);
+	void SetUniformValue(UniformId uniform, uniformCall call, unsigned int count, const void* data);
+
+	void DeferUniformValue(std::string_view uniformName, uniformCall call, unsigned int count, const void* data);
+
+	// Upload the deferred values to the newly linked program
+	void ApplyDeferredUniforms(unsigned int programId);
+
+	// Print a message and return nullptr if the program has no such uniform
+	const uniformInfo* FindUniform(std::string_view uniformName);
+	const uniformInfo* FindUniform(UniformId uniform);
+
+	static ProgramBinaryCache* s_BinaryCache;
+	static ShaderCompiler* s_LazyCompiler;
 
 	std::string m_FilePath;
 	unsigned int m_RendererID;
 
+	// #define lines injected after #version, kept so hot reloads build the same variant
+	std::string m_Defines;
+
+	unsigned long long m_SourceHash;
+
+	// A lazy shader's parsed source, kept until its program is built
+	shaderProgSource m_DeferredSource;
+	bool m_bCompilePending;
+
+	// Set while the program is waiting in a ShaderCompiler batch
+	ShaderCompiler* m_pCompiler;
+
+	// Set while a ShaderWatcher is watching the file
+	ShaderWatcher* m_pWatcher;
+
 	// uniform caching
-	
+	UniformCache m_UniformCache;
+
+	// Values set while the program wasn't ready, the latest per uniform
+	std::vector<deferredUniform> m_vDeferredUniforms;
+
+	std::vector<attributeInfo> m_vAttributes;
+
+	// Layout hash and result of every compatibility check done against the current program
+	std::vector<std::pair<unsigned long long, bool>> m_vLayoutChecks;
+
+	// Uniform block name and binding point pairs set with BindUniformBlock
+	std::vector<std::pair<std::string, unsigned int>> m_vBlockBindings;
 
+	// Shader storage block name and binding point pairs set with BindStorageBlock
+	std::vector<std::pair<std::string, unsigned int>> m_vStorageBindings;
 
+	bool m_bCompute;
 
+	// local_size_x/y/z of a compute program, all 0 otherwise
+	unsigned int m_WorkGroupSize[3];
 };
\ No newline at end of file
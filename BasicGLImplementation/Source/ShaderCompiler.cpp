@@ -0,0 +1,125 @@
+#include "ShaderCompiler.h"
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+ShaderCompiler::ShaderCompiler()
+	: m_bCompletionQuery(GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)
+{
+	// Let the driver use as many compiler threads as it likes
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+	}
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+	WaitAll();
+}
+
+void ShaderCompiler::Submit(Shader& shader, const shaderProgSource& source)
+{
+	pendingProgram pending;
+
+	// Programs loaded from the binary cache are ready straight away
+	if (shader.BeginProgram(source, pending))
+	{
+		shader.m_RendererID = pending.programId;
+		return;
+	}
+
+	shader.m_pCompiler = this;
+	m_vPending.push_back(pending);
+}
+
+unsigned int ShaderCompiler::Poll()
+{
+	for (unsigned int i = 0; i < m_vPending.size(); )
+	{
+		int completed = GL_TRUE;
+
+		// GL_COMPLETION_STATUS_KHR never blocks, unlike GL_LINK_STATUS
+		if (m_bCompletionQuery)
+		{
+			GLCall(glGetProgramiv(m_vPending[i].programId, GL_COMPLETION_STATUS_KHR, &completed));
+		}
+
+		if (completed != GL_TRUE)
+		{
+			i++;
+			continue;
+		}
+
+		Finish(m_vPending[i]);
+
+		m_vPending[i] = m_vPending.back();
+		m_vPending.pop_back();
+	}
+
+	return (unsigned int)m_vPending.size();
+}
+
+void ShaderCompiler::WaitAll()
+{
+	// Every program was submitted before any of them is waited on, so the driver has had the whole batch to work with
+	for (pendingProgram& pending : m_vPending)
+		Finish(pending);
+
+	m_vPending.clear();
+}
+
+void ShaderCompiler::Wait(Shader& shader)
+{
+	for (unsigned int i = 0; i < m_vPending.size(); i++)
+	{
+		if (m_vPending[i].shader != &shader)
+			continue;
+
+		Finish(m_vPending[i]);
+
+		m_vPending[i] = m_vPending.back();
+		m_vPending.pop_back();
+		return;
+	}
+}
+
+void ShaderCompiler::Cancel(Shader& shader)
+{
+	for (unsigned int i = 0; i < m_vPending.size(); i++)
+	{
+		pendingProgram& pending = m_vPending[i];
+
+		if (pending.shader != &shader)
+			continue;
+
+		for (unsigned int shaderId : pending.shaderIds)
+		{
+			if (shaderId != 0)
+			{
+				GLCall(glDeleteShader(shaderId));
+			}
+		}
+
+		GLCall(glDeleteProgram(pending.programId));
+
+		shader.m_pCompiler = nullptr;
+
+		m_vPending[i] = m_vPending.back();
+		m_vPending.pop_back();
+		return;
+	}
+}
+
+void ShaderCompiler::Finish(pendingProgram& pending)
+{
+	Shader& shader = *pending.shader;
+
+	shader.m_RendererID = shader.FinishProgram(pending);
+	shader.m_pCompiler = nullptr;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "Shader.h"
+
+// Batches program compilation so the driver can compile every shader in parallel.
+// Programs are submitted without querying any status (which would force the driver to finish that program first)
+// and are finished off later by Poll, which uses GL_COMPLETION_STATUS_KHR when KHR_parallel_shader_compile is
+// available so the render loop can keep running while programs are still compiling.
+class ShaderCompiler
+{
+private:
+
+	std::vector<pendingProgram> m_vPending;
+
+	// Whether the driver can tell us a program has finished without blocking
+	bool m_bCompletionQuery;
+
+	void Finish(pendingProgram& pending);
+
+public:
+
+	// Must be constructed after the GL context has been created
+	ShaderCompiler();
+	~ShaderCompiler();
+
+	// Called by the Shader constructor, starts compiling and linking the shader's program
+	void Submit(Shader& shader, const shaderProgSource& source);
+
+	// Finish every program the driver has completed, returns how many are still compiling.
+	// Without KHR_parallel_shader_compile there is no way to ask without blocking so everything is finished.
+	unsigned int Poll();
+
+	// Block until every submitted program is finished
+	void WaitAll();
+
+	// Block until one shader's program is finished, does nothing if it isn't in this batch
+	void Wait(Shader& shader);
+
+	// Drop a program that hasn't finished yet, used when a Shader is destroyed before it is ready
+	void Cancel(Shader& shader);
+
+	inline bool IsIdle() const { return m_vPending.empty(); }
+	inline unsigned int GetPendingCount() const { return (unsigned int)m_vPending.size(); }
+};
@@ -0,0 +1,70 @@
+#include "ShaderLibrary.h"
+
+#include <filesystem>
+
+#include "Hash.h"
+#include "ShaderWatcher.h"
+
+ShaderLibrary::ShaderLibrary(ShaderWatcher* watcher)
+	: m_pWatcher(watcher), m_iPathHits(0), m_iSourceHits(0), m_iPrograms(0)
+{
+}
+
+std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& filePath, ShaderLoad load)
+{
+	// "Res/Shaders/../Shaders/Basic.shader" and "Res/Shaders/Basic.shader" are the same file
+	std::string path = std::filesystem::path(filePath).lexically_normal().generic_string();
+
+	auto byPath = m_ByPath.find(path);
+
+	if (byPath != m_ByPath.end())
+	{
+		if (std::shared_ptr<Shader> shader = byPath->second.lock())
+		{
+			m_iPathHits++;
+			return shader;
+		}
+	}
+
+	shaderProgSource source = Shader::ParseShader(path);
+
+	if (!source.valid)
+		return nullptr;
+
+	// Same seed Shader uses for its source hash when there are no defines
+	unsigned long long sourceHash = HashShaderSource(source, HashBytes(""));
+
+	std::shared_ptr<Shader> shader = m_BySource[sourceHash].lock();
+
+	// The shader has been reloaded with different source since it was stored here, move it to its current hash
+	if (shader && shader->GetSourceHash() != sourceHash)
+	{
+		std::weak_ptr<Shader>& current = m_BySource[shader->GetSourceHash()];
+
+		if (current.expired())
+			current = shader;
+
+		m_BySource[sourceHash].reset();
+		shader = nullptr;
+	}
+
+	if (shader)
+	{
+		m_iSourceHits++;
+	}
+	else
+	{
+		shader = std::make_shared<Shader>(path, std::move(source), load);
+		m_BySource[sourceHash] = shader;
+
+		m_iPrograms++;
+	}
+
+	m_ByPath[path] = shader;
+
+	// A shader shared by several files is watched through each of them, an edit to any one must reach it
+	if (m_pWatcher)
+		m_pWatcher->Watch(*shader, path);
+
+	return shader;
+}
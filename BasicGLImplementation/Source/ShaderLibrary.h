@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Shader.h"
+
+class ShaderWatcher;
+
+// Shares programs between everything that loads the same shader.
+// Shaders are interned by path and by a hash of their parsed source, so a second path to a file with identical
+// stages (eg a duplicated material definition) gets the program that already exists instead of compiling another.
+// Handles are shared pointers, the GL program is deleted when the last handle to it is released.
+// A hot reloaded shader no longer matches the source hash it was interned under, so entries are checked against the
+// shader's current hash when they are found and moved to it if it has changed.
+class ShaderLibrary
+{
+private:
+
+	// Entries don't keep their shaders alive, a dead entry is replaced the next time its path or source is loaded
+	std::unordered_map<std::string, std::weak_ptr<Shader>> m_ByPath;
+	std::unordered_map<unsigned long long, std::weak_ptr<Shader>> m_BySource;
+
+	// Every path a shader is loaded from is watched with this, if there is one
+	ShaderWatcher* m_pWatcher;
+
+	unsigned int m_iPathHits;
+	unsigned int m_iSourceHits;
+	unsigned int m_iPrograms;
+
+public:
+
+	// With a watcher set the shared program is reloaded when any of the files that map to it changes.
+	// The watcher must outlive the library's shaders.
+	ShaderLibrary(ShaderWatcher* watcher = nullptr);
+
+	// Returns the shader already loaded from this path or with the same source, otherwise creates it.
+	// The load mode only applies to a shader that has to be created. Returns nullptr if the file can't be loaded.
+	std::shared_ptr<Shader> Load(const std::string& filePath, ShaderLoad load = ShaderLoad::Immediate);
+
+	// Loads answered by path without touching the file, and by source hash after parsing it
+	inline unsigned int GetPathHits() const { return m_iPathHits; }
+	inline unsigned int GetSourceHits() const { return m_iSourceHits; }
+
+	// Shaders the library has created, each one is a separate GL program
+	inline unsigned int GetProgramCount() const { return m_iPrograms; }
+};
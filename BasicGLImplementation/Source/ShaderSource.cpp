@@ -0,0 +1,260 @@
+#include "ShaderSource.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include "GL/glew.h"
+
+#include "Hash.h"
+#include "Renderer.h"
+
+static const unsigned int s_StageGLTypes[ShaderStageCount] = {
+	GL_VERTEX_SHADER,
+	GL_FRAGMENT_SHADER,
+	GL_GEOMETRY_SHADER,
+	GL_TESS_CONTROL_SHADER,
+	GL_TESS_EVALUATION_SHADER,
+	GL_COMPUTE_SHADER
+};
+
+const char* GetShaderStageName(ShaderStage stage)
+{
+	return ShaderStageNames[(unsigned int)stage];
+}
+
+unsigned int GetShaderStageGLType(ShaderStage stage)
+{
+	return s_StageGLTypes[(unsigned int)stage];
+}
+
+ShaderDefines& ShaderDefines::Set(std::string_view name, std::string_view value)
+{
+	// Insert in name order, replacing the value if the define is already in the set
+	auto it = m_vDefines.begin();
+
+	while (it != m_vDefines.end() && it->first < name)
+		++it;
+
+	if (it != m_vDefines.end() && it->first == name)
+		it->second = std::string(value);
+	else
+		m_vDefines.insert(it, { std::string(name), std::string(value) });
+
+	return *this;
+}
+
+std::string ShaderDefines::GetPrelude() const
+{
+	std::string prelude;
+
+	for (const auto& define : m_vDefines)
+		prelude += "#define " + define.first + " " + define.second + "\n";
+
+	return prelude;
+}
+
+unsigned long long ShaderDefines::GetHash(unsigned long long seed) const
+{
+	unsigned long long hash = seed;
+
+	for (const auto& define : m_vDefines)
+	{
+		hash = HashBytes("#define ", hash);
+		hash = HashBytes(define.first, hash);
+		hash = HashBytes(" ", hash);
+		hash = HashBytes(define.second, hash);
+		hash = HashBytes("\n", hash);
+	}
+
+	return hash;
+}
+
+unsigned long long HashShaderSource(const shaderProgSource& source, unsigned long long seed)
+{
+	unsigned long long hash = seed;
+
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (!source.HasStage((ShaderStage)i))
+			continue;
+
+		hash = HashBytes(ShaderStageNames[i], hash);
+		hash = HashBytes(source.stages[i].text, hash);
+	}
+
+	return hash;
+}
+
+size_t FindVersionLineEnd(std::string_view text)
+{
+	size_t lineStart = 0;
+
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+
+		if (lineEnd == std::string_view::npos)
+			lineEnd = text.size();
+
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		size_t firstChar = line.find_first_not_of(" \t\r");
+
+		if (firstChar != std::string_view::npos)
+		{
+			if (line.compare(firstChar, 8, "#version") == 0)
+				return lineEnd < text.size() ? lineEnd + 1 : text.size();
+
+			// #version has to come before anything other than comments
+			if (line.compare(firstChar, 2, "//") != 0)
+				return 0;
+		}
+
+		lineStart = lineEnd + 1;
+	}
+
+	return 0;
+}
+
+static void PrintParseError(std::string_view name, unsigned int line, const std::string& message)
+{
+	std::cout << name << "(" << line << "): " << message << std::endl;
+}
+
+bool ParseShaderSource(std::string_view text, std::string_view name, shaderProgSource& source)
+{
+	auto printError = [name](ShaderParseError error, unsigned int line, std::string_view tag, unsigned int otherLine)
+	{
+		switch (error)
+		{
+		case ShaderParseError::UnknownStage:
+			PrintParseError(name, line, "unknown shader stage '" + std::string(tag) + "'");
+			break;
+		case ShaderParseError::RepeatedStage:
+			PrintParseError(name, line, "second " + std::string(tag) + " stage, it was already started on line " + std::to_string(otherLine));
+			break;
+		case ShaderParseError::TextOutsideStage:
+			PrintParseError(name, line, "source outside of a #shader section");
+			break;
+		case ShaderParseError::ComputeWithOtherStages:
+			PrintParseError(name, line, "a compute shader can't be combined with other stages");
+			break;
+		case ShaderParseError::NoVertexStage:
+			PrintParseError(name, line, "no vertex stage");
+			break;
+		}
+	};
+
+	source.valid = SplitShaderStages(text, source.stages, printError);
+
+	return source.valid;
+}
+
+shaderProgSource CopyShaderSource(const shaderProgSource& source)
+{
+	shaderProgSource copy;
+	copy.valid = source.valid;
+
+	size_t totalLength = 0;
+
+	for (const shaderStageSource& stage : source.stages)
+		totalLength += stage.text.size();
+
+	// One block for every stage, the views are pointed back into it as it is filled
+	copy.ownedText = std::make_unique<char[]>(totalLength + 1);
+
+	char* text = copy.ownedText.get();
+
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		const shaderStageSource& stage = source.stages[i];
+
+		std::copy(stage.text.begin(), stage.text.end(), text);
+
+		copy.stages[i].text = std::string_view(text, stage.text.size());
+		copy.stages[i].firstLine = stage.firstLine;
+
+		text += stage.text.size();
+	}
+
+	return copy;
+}
+
+#ifdef EMBED_SHADERS
+// Generated before the build by Tools/EmbedShaders.py, defines s_EmbeddedShaders
+#include "Generated/EmbeddedShaders.h"
+#endif
+
+const embeddedShader* FindEmbeddedShader([[maybe_unused]] std::string_view path)
+{
+#ifdef EMBED_SHADERS
+	// The generator records paths relative to the project directory with forward slashes, the same way Main names them
+	std::string normalPath = std::filesystem::path(path).lexically_normal().generic_string();
+
+	for (const embeddedShader& embedded : s_EmbeddedShaders)
+	{
+		if (embedded.path == normalPath)
+			return &embedded;
+	}
+#endif
+
+	return nullptr;
+}
+
+unsigned int CompileShaderStage(ShaderStage stage, const shaderStageSource& src, const std::string& prelude)
+{
+	// Create the shader id 
+	unsigned int shaderId = glCreateShader(GetShaderStageGLType(stage));
+
+	// The stage is handed over in pieces without copying it: everything up to the #version line, the prelude
+	// (#define lines etc), a #line directive, then the rest. #line makes compile errors refer to lines of the .shader file.
+	const char* text = src.text.empty() ? "" : src.text.data();
+	size_t versionEnd = FindVersionLineEnd(src.text);
+
+	unsigned int restFirstLine = src.firstLine;
+
+	for (size_t i = 0; i < versionEnd; i++)
+	{
+		if (text[i] == '\n')
+			restFirstLine++;
+	}
+
+	char lineDirective[32];
+	int lineDirectiveLength = snprintf(lineDirective, sizeof(lineDirective), "#line %u\n", restFirstLine);
+
+	const char* pieces[4] = { text, prelude.c_str(), lineDirective, text + versionEnd };
+	int lengths[4] = { (int)versionEnd, (int)prelude.size(), lineDirectiveLength, (int)(src.text.size() - versionEnd) };
+
+	// Set the sharder source code using the pieces and their lengths, the stage text isn't null terminated
+	GLCall(glShaderSource(shaderId, 4, pieces, lengths));
+
+	// Compile the shader scource code, the result is checked later by CheckShaderStageCompiled
+	GLCall(glCompileShader(shaderId));
+
+	return shaderId;
+}
+
+bool CheckShaderStageCompiled(unsigned int shaderId, ShaderStage stage, std::string_view name)
+{
+	// Create int to hold shader query return value
+	int shader_compiled;
+
+	// Get shader value based on flag sent as arg (for this cal was GL_COMPILE_STATUS)
+	GLCall(glGetShaderiv(shaderId, GL_COMPILE_STATUS, &shader_compiled));
+
+	// if the compilation status is not GL_TRUE (if the compile failed)
+	if (shader_compiled != GL_TRUE)
+	{
+		// Get the message from the shader log
+		GLsizei log_length = 0;
+		GLchar message[1024];
+		GLCall(glGetShaderInfoLog(shaderId, 1024, &log_length, message));
+
+		std::cout << "Failed to compile " << GetShaderStageName(stage) << " shader in " << name << ", message: " << message << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+
+enum class ShaderStage : unsigned int
+{
+	Vertex = 0,
+	Fragment,
+	Geometry,
+	TessControl,
+	TessEvaluation,
+	Compute
+};
+
+constexpr unsigned int ShaderStageCount = 6;
+
+// Names used to tag the stages in a shader file, eg "#shader tess_control"
+inline constexpr const char* ShaderStageNames[ShaderStageCount] = { "vertex", "fragment", "geometry", "tess_control", "tess_evaluation", "compute" };
+
+const char* GetShaderStageName(ShaderStage stage);
+
+// GL_VERTEX_SHADER etc
+unsigned int GetShaderStageGLType(ShaderStage stage);
+
+struct shaderStageSource
+{
+	std::string_view	text;
+	unsigned int		firstLine;	// Line of the file the text starts on, 0 if the stage isn't present
+};
+
+struct shaderProgSource
+{
+	// Keeps the text the stages point into alive when the source was loaded from a file
+	MappedFile			file;
+
+	// Or holds the text itself for sources made by CopyShaderSource
+	std::unique_ptr<char[]>	ownedText;
+
+	shaderStageSource	stages[ShaderStageCount];
+
+	bool				valid = false;
+
+	inline const shaderStageSource& GetStage(ShaderStage stage) const { return stages[(unsigned int)stage]; }
+	inline bool HasStage(ShaderStage stage) const { return stages[(unsigned int)stage].firstLine != 0; }
+};
+
+// A set of preprocessor defines used to build a specialised variant of a shader (eg INSTANCING, SKINNING, FOG).
+// Defines are kept sorted by name so the same set always produces the same text and hash whatever order it was built in.
+class ShaderDefines
+{
+private:
+
+	std::vector<std::pair<std::string, std::string>> m_vDefines;
+
+public:
+
+	// Add a define or change its value
+	ShaderDefines& Set(std::string_view name, std::string_view value = "1");
+
+	// The #define lines injected into every stage just after #version
+	std::string GetPrelude() const;
+
+	// Same as hashing GetPrelude() but without building the string, for looking variants up every frame
+	unsigned long long GetHash(unsigned long long seed) const;
+
+	inline bool IsEmpty() const { return m_vDefines.empty(); }
+};
+
+// Hash of every stage present in the source, stage names included so moving text between stages changes the hash
+unsigned long long HashShaderSource(const shaderProgSource& source, unsigned long long seed);
+
+// Offset just past the #version line, or 0 if the text has no #version line.
+// Anything injected into a stage (#line, #define) has to go here since only comments may come before #version.
+size_t FindVersionLineEnd(std::string_view text);
+
+// Everything the splitting rules can object to
+enum class ShaderParseError
+{
+	UnknownStage,			// '#shader <tag>' with a tag that isn't a stage name
+	RepeatedStage,			// a second section for a stage, otherLine is the line of the first tag
+	TextOutsideStage,		// non blank text before the first tag or in a rejected section
+	ComputeWithOtherStages,	// a compute stage alongside any other stage
+	NoVertexStage			// a graphics program without a vertex stage
+};
+
+// The rules for splitting a shader file into its '#shader <stage>' sections, in a single pass.
+// Shared by ParseShaderSource and EmbedShader so a file and its embedded copy are always split the same way.
+// onError(error, line, tag, otherLine) is called for every problem, returns false if there were any.
+template<typename ErrorHandler>
+constexpr bool SplitShaderStages(std::string_view text, shaderStageSource (&stages)[ShaderStageCount], ErrorHandler&& onError)
+{
+	for (shaderStageSource& stage : stages)
+	{
+		stage.text = std::string_view();
+		stage.firstLine = 0;
+	}
+
+	bool succeeded = true;
+
+	// Stage the lines currently belong to, -1 before the first tag or after a bad one
+	int currentStage = -1;
+	bool inBadSection = false;
+
+	size_t stageStart = 0;
+	size_t lineStart = 0;
+	unsigned int lineNumber = 1;
+
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+
+		if (lineEnd == std::string_view::npos)
+			lineEnd = text.size();
+
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		size_t firstChar = line.find_first_not_of(" \t\r");
+
+		// Only lines that start with the tag switch stage, the tag can't appear in the middle of GLSL
+		if (firstChar != std::string_view::npos && line.compare(firstChar, 7, "#shader") == 0)
+		{
+			// End the previous stage just before this tag line
+			if (currentStage != -1)
+				stages[currentStage].text = text.substr(stageStart, lineStart - stageStart);
+
+			std::string_view tag = line.substr(firstChar + 7);
+			size_t tagStart = tag.find_first_not_of(" \t\r");
+			tag = tagStart == std::string_view::npos ? std::string_view() : tag.substr(tagStart);
+			tag = tag.substr(0, tag.find_first_of(" \t\r"));
+
+			currentStage = -1;
+			inBadSection = true;
+
+			for (unsigned int i = 0; i < ShaderStageCount; i++)
+			{
+				if (tag == ShaderStageNames[i])
+				{
+					currentStage = (int)i;
+					break;
+				}
+			}
+
+			if (currentStage == -1)
+			{
+				onError(ShaderParseError::UnknownStage, lineNumber, tag, 0u);
+				succeeded = false;
+			}
+			else if (stages[currentStage].firstLine != 0)
+			{
+				onError(ShaderParseError::RepeatedStage, lineNumber, tag, stages[currentStage].firstLine - 1);
+				succeeded = false;
+				currentStage = -1;
+			}
+			else
+			{
+				inBadSection = false;
+				stageStart = lineEnd < text.size() ? lineEnd + 1 : text.size();
+				stages[currentStage].firstLine = lineNumber + 1;
+			}
+		}
+		else if (currentStage == -1 && !inBadSection && firstChar != std::string_view::npos)
+		{
+			// Report text outside of any stage once rather than for every line of it
+			onError(ShaderParseError::TextOutsideStage, lineNumber, std::string_view(), 0u);
+			succeeded = false;
+			inBadSection = true;
+		}
+
+		lineStart = lineEnd + 1;
+		lineNumber++;
+	}
+
+	if (currentStage != -1)
+		stages[currentStage].text = text.substr(stageStart);
+
+	// A program is either a single compute stage or a graphics pipeline that at least has a vertex stage
+	if (stages[(unsigned int)ShaderStage::Compute].firstLine != 0)
+	{
+		for (unsigned int i = 0; i < ShaderStageCount; i++)
+		{
+			if (i != (unsigned int)ShaderStage::Compute && stages[i].firstLine != 0)
+			{
+				onError(ShaderParseError::ComputeWithOtherStages, stages[i].firstLine - 1, std::string_view(ShaderStageNames[i]), 0u);
+				succeeded = false;
+			}
+		}
+	}
+	else if (stages[(unsigned int)ShaderStage::Vertex].firstLine == 0)
+	{
+		onError(ShaderParseError::NoVertexStage, lineNumber - 1, std::string_view(), 0u);
+		succeeded = false;
+	}
+
+	return succeeded;
+}
+
+// Split the text of a shader file into its stages with SplitShaderStages.
+// The stages are views into text so nothing is copied, errors are printed as "name(line): message".
+bool ParseShaderSource(std::string_view text, std::string_view name, shaderProgSource& source);
+
+// Copy of the source whose stages point into memory it owns instead of the file mapping.
+// Anything that keeps a source after the file could be edited needs one, a mapping shows the file being rewritten
+// underneath it and reading past the end of a file that was cut short raises SIGBUS.
+shaderProgSource CopyShaderSource(const shaderProgSource& source);
+
+// A shader file compiled into the executable, already split into stages
+struct embeddedShader
+{
+	std::string_view	path;
+	shaderStageSource	stages[ShaderStageCount];
+	bool				valid;
+};
+
+// Split a shader at compile time, used by the header Tools/EmbedShaders.py generates for builds with EMBED_SHADERS defined
+constexpr embeddedShader EmbedShader(std::string_view path, std::string_view text)
+{
+	embeddedShader embedded{};
+	embedded.path = path;
+
+	// Nothing can be printed at compile time, the generated header static_asserts on valid instead
+	embedded.valid = SplitShaderStages(text, embedded.stages, [](ShaderParseError, unsigned int, std::string_view, unsigned int) {});
+
+	return embedded;
+}
+
+// The embedded copy of the shader file at the path, nullptr if there isn't one (always the case without EMBED_SHADERS)
+const embeddedShader* FindEmbeddedShader(std::string_view path);
+
+// Create a shader object for one stage and start compiling it with the prelude injected after #version.
+// The status isn't queried here so the driver can keep compiling in the background, check it with CheckShaderStageCompiled.
+unsigned int CompileShaderStage(ShaderStage stage, const shaderStageSource& src, const std::string& prelude);
+
+// Prints the info log with the name of the shader file if the stage failed to compile
+bool CheckShaderStageCompiled(unsigned int shaderId, ShaderStage stage, std::string_view name);
@@ -0,0 +1,43 @@
+#include "ShaderStorageBuffer.h"
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(unsigned int size, unsigned int binding, const void* data)
+    : m_iSize(size), m_iBinding(binding)
+{
+    // Create the buffer, GL_DYNAMIC_COPY because it is written by the GPU and read back by the GPU
+    GLCall(glGenBuffers(1, &m_RendererId));
+    GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererId));
+    GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_COPY));
+
+    // Attach it to its binding point so shader storage blocks linked to the binding point use it
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_iBinding, m_RendererId));
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+    GLCall(glDeleteBuffers(1, &m_RendererId));
+}
+
+void ShaderStorageBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    ASSERT(offset + size <= m_iSize);
+
+    GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererId));
+    GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::GetData(void* data, unsigned int size, unsigned int offset) const
+{
+    ASSERT(offset + size <= m_iSize);
+
+    GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererId));
+    GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::Bind() const
+{
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_iBinding, m_RendererId));
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// A GL shader storage buffer (SSBO) attached to a binding point, for data that compute shaders read and write.
+// The same buffer can be bound as a vertex buffer or used as the arguments of an indirect dispatch.
+class ShaderStorageBuffer
+{
+private:
+
+	unsigned int m_RendererId;
+	unsigned int m_iSize;
+	unsigned int m_iBinding;
+
+public:
+
+	// data may be nullptr to leave the contents undefined until a shader or SetData writes them
+	ShaderStorageBuffer(unsigned int size, unsigned int binding, const void* data = nullptr);
+	~ShaderStorageBuffer();
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	// Copy the contents back, this waits for the GPU. Call Shader::BufferUpdateBarrier first if a dispatch wrote them.
+	void GetData(void* data, unsigned int size, unsigned int offset = 0) const;
+
+	// Attach the buffer to its binding point
+	void Bind() const;
+
+	inline unsigned int GetRendererId() const { return m_RendererId; }
+	inline unsigned int GetSize() const { return m_iSize; }
+	inline unsigned int GetBinding() const { return m_iBinding; }
+};
@@ -0,0 +1,54 @@
+#include "ShaderVariants.h"
+
+#include "Hash.h"
+
+ShaderVariants::ShaderVariants(const std::string& filePath)
+	: m_FilePath(filePath)
+{
+	std::error_code error;
+	m_WriteTime = std::filesystem::last_write_time(m_FilePath, error);
+
+	m_Source = CopyShaderSource(Shader::ParseShader(m_FilePath));
+}
+
+void ShaderVariants::RefreshSource()
+{
+	// Embedded shaders have no file to check, the error just leaves them as they are
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(m_FilePath, error);
+
+	if (error || writeTime == m_WriteTime)
+		return;
+
+	shaderProgSource source = Shader::ParseShader(m_FilePath);
+
+	// Keep the old text if the file is half written, the next miss tries again
+	if (!source.valid)
+		return;
+
+	m_WriteTime = writeTime;
+	m_Source = CopyShaderSource(source);
+
+	// Each variant keeps its own defines through a reload
+	for (auto& variant : m_Variants)
+		variant.second->Reload(m_Source);
+}
+
+Shader& ShaderVariants::Get(const ShaderDefines& defines)
+{
+	unsigned long long key = defines.GetHash(HashBytes(""));
+
+	auto it = m_Variants.find(key);
+
+	if (it != m_Variants.end())
+		return *it->second;
+
+	// Only checked when a variant has to be built, looking variants up stays a hash and a find
+	RefreshSource();
+
+	// First use of this define set, compile the specialised program
+	std::unique_ptr<Shader>& variant = m_Variants[key];
+	variant = std::make_unique<Shader>(m_FilePath, m_Source, defines);
+
+	return *variant;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Shader.h"
+
+// Specialised programs built from one shader file.
+// The file is parsed once, each distinct define set is compiled the first time it is asked for and reused after that,
+// so features like instancing, skinning or fog are compiled in rather than branched on with uniforms at runtime.
+// If the file has been edited since it was parsed it is parsed again before a new variant is built, and the variants
+// built so far are reloaded with it so every define set comes from the same text.
+class ShaderVariants
+{
+private:
+
+	std::string m_FilePath;
+
+	// A copy rather than the mapping, the file can be rewritten while variants are still being built from it
+	shaderProgSource m_Source;
+
+	// Last write time of the file when m_Source was parsed
+	std::filesystem::file_time_type m_WriteTime;
+
+	// Keyed on the hash of the define set
+	std::unordered_map<unsigned long long, std::unique_ptr<Shader>> m_Variants;
+
+	// Parse the file again if it has changed since m_Source was read
+	void RefreshSource();
+
+public:
+
+	ShaderVariants(const std::string& filePath);
+
+	// Returns the variant for the define set, compiling it if this is the first time it has been used
+	Shader& Get(const ShaderDefines& defines);
+
+	inline unsigned int GetVariantCount() const { return (unsigned int)m_Variants.size(); }
+};
@@ -0,0 +1,310 @@
+#include "ShaderWatcher.h"
+
+#include <chrono>
+#include <iostream>
+
+#ifdef __linux__
+	#include <poll.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher()
+	: m_bRunning(true)
+{
+#ifdef __linux__
+	m_iNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (m_iNotify == -1)
+		std::cout << "Failed to start inotify, shader hot reload is disabled" << std::endl;
+#endif
+
+	m_Thread = std::thread(&ShaderWatcher::Run, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	m_bRunning = false;
+	m_Thread.join();
+
+	// Shaders outliving the watcher mustn't try to unwatch themselves later
+	for (watchedShader& watched : m_vWatched)
+		watched.shader->m_pWatcher = nullptr;
+
+#ifdef __linux__
+	if (m_iNotify != -1)
+		close(m_iNotify);
+#endif
+}
+
+void ShaderWatcher::Watch(Shader& shader)
+{
+	Watch(shader, shader.GetFilePath());
+}
+
+void ShaderWatcher::Watch(Shader& shader, const std::string& filePath)
+{
+	// Embedded shaders never come from the file, so there is nothing to reload them from
+	if (FindEmbeddedShader(filePath))
+		return;
+
+	std::filesystem::path path = std::filesystem::path(filePath).lexically_normal();
+
+	watchedShader watched;
+	watched.shader = &shader;
+	watched.path = path.string();
+	watched.directory = path.has_parent_path() ? path.parent_path().string() : ".";
+	watched.fileName = path.filename().string();
+
+	std::error_code error;
+	watched.lastWrite = std::filesystem::last_write_time(path, error);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	for (const watchedShader& existing : m_vWatched)
+	{
+		if (existing.shader == &shader && existing.path == watched.path)
+			return;
+	}
+
+#ifdef __linux__
+	// Watch the directory rather than the file, editors often save by writing a new file and renaming it over the old one
+	if (m_iNotify != -1)
+	{
+		int watchId = inotify_add_watch(m_iNotify, watched.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+		bool known = false;
+
+		// Adding a directory twice returns the existing watch descriptor
+		for (const auto& watchedDirectory : m_vDirectories)
+			known = known || watchedDirectory.first == watchId;
+
+		if (watchId == -1)
+			std::cout << "Failed to watch " << watched.directory << " for shader changes" << std::endl;
+		else if (!known)
+			m_vDirectories.push_back({ watchId, watched.directory });
+	}
+#endif
+
+	shader.m_pWatcher = this;
+	m_vWatched.push_back(watched);
+}
+
+void ShaderWatcher::Unwatch(Shader& shader)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	for (unsigned int i = 0; i < m_vWatched.size(); )
+	{
+		if (m_vWatched[i].shader == &shader)
+		{
+			m_vWatched[i] = m_vWatched.back();
+			m_vWatched.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+#ifdef __linux__
+	// Stop watching directories that no longer hold any watched file, otherwise every save in them wakes the worker
+	for (unsigned int i = 0; i < m_vDirectories.size(); )
+	{
+		bool inUse = false;
+
+		for (const watchedShader& watched : m_vWatched)
+			inUse = inUse || watched.directory == m_vDirectories[i].second;
+
+		if (!inUse)
+		{
+			inotify_rm_watch(m_iNotify, m_vDirectories[i].first);
+
+			m_vDirectories[i] = m_vDirectories.back();
+			m_vDirectories.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+#endif
+
+	for (unsigned int i = 0; i < m_vReloads.size(); )
+	{
+		if (m_vReloads[i].shader == &shader)
+		{
+			m_vReloads[i] = std::move(m_vReloads.back());
+			m_vReloads.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	shader.m_pWatcher = nullptr;
+}
+
+unsigned int ShaderWatcher::ApplyChanges()
+{
+	std::vector<shaderReload> reloads;
+
+	// Take the finished reparses and let the worker carry on while the programs are relinked
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		reloads.swap(m_vReloads);
+	}
+
+	unsigned int replaced = 0;
+
+	for (shaderReload& reload : reloads)
+	{
+		if (reload.shader->Reload(reload.source))
+			replaced++;
+	}
+
+	return replaced;
+}
+
+void ShaderWatcher::FileChanged(const std::string& directory, const std::string& fileName)
+{
+	std::vector<Shader*> shaders;
+	std::string path;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (const watchedShader& watched : m_vWatched)
+		{
+			if (watched.directory == directory && watched.fileName == fileName)
+			{
+				shaders.push_back(watched.shader);
+				path = watched.path;
+			}
+		}
+	}
+
+	if (shaders.empty())
+		return;
+
+	// Reading and parsing happens here so the render thread only has to compile and link
+	shaderProgSource parsed = Shader::ParseShader(path);
+
+	// A half written file is caught again by the event for the write that finishes it
+	if (!parsed.valid)
+		return;
+
+	// The parsed stages point into the file mapping, which shows the next edit of the file while the reload
+	// waits for a frame boundary, so every shader queues a copy of the text it owns instead
+	for (Shader* shader : shaders)
+	{
+		shaderProgSource source = CopyShaderSource(parsed);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// The shader may have been unwatched while the file was being parsed
+		bool stillWatched = false;
+
+		for (const watchedShader& watched : m_vWatched)
+			stillWatched = stillWatched || watched.shader == shader;
+
+		if (!stillWatched)
+			continue;
+
+		// Only the latest version of the file matters if it changed again before the last frame boundary
+		bool replacedReload = false;
+
+		for (shaderReload& reload : m_vReloads)
+		{
+			if (reload.shader == shader)
+			{
+				reload.source = std::move(source);
+				replacedReload = true;
+				break;
+			}
+		}
+
+		if (!replacedReload)
+			m_vReloads.push_back({ shader, std::move(source) });
+	}
+}
+
+#ifdef __linux__
+
+void ShaderWatcher::Run()
+{
+	if (m_iNotify == -1)
+		return;
+
+	alignas(inotify_event) char buffer[4096];
+
+	while (m_bRunning)
+	{
+		// Wake up regularly to check whether the watcher is being destroyed
+		pollfd notifyFd = { m_iNotify, POLLIN, 0 };
+
+		if (poll(&notifyFd, 1, 100) <= 0)
+			continue;
+
+		ssize_t length = read(m_iNotify, buffer, sizeof(buffer));
+
+		for (ssize_t offset = 0; offset < length; )
+		{
+			const inotify_event* event = (const inotify_event*)(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if (event->len == 0)
+				continue;
+
+			std::string directory;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				for (const auto& watchedDirectory : m_vDirectories)
+				{
+					if (watchedDirectory.first == event->wd)
+						directory = watchedDirectory.second;
+				}
+			}
+
+			if (!directory.empty())
+				FileChanged(directory, event->name);
+		}
+	}
+}
+
+#else
+
+void ShaderWatcher::Run()
+{
+	// No inotify here, compare the modification times of the watched files a few times a second instead
+	while (m_bRunning)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+		std::vector<std::pair<std::string, std::string>> changed;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			for (watchedShader& watched : m_vWatched)
+			{
+				std::error_code error;
+				std::filesystem::file_time_type lastWrite = std::filesystem::last_write_time(watched.path, error);
+
+				if (!error && lastWrite != watched.lastWrite)
+				{
+					watched.lastWrite = lastWrite;
+					changed.push_back({ watched.directory, watched.fileName });
+				}
+			}
+		}
+
+		for (const auto& file : changed)
+			FileChanged(file.first, file.second);
+	}
+}
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Shader.h"
+
+// Hot reloads shaders when their files change.
+// A worker thread waits for changes (inotify on Linux, polling file times elsewhere) and reparses the changed
+// files, the render thread then relinks only the affected programs when it calls ApplyChanges at a frame boundary.
+// A program that fails to build is discarded and the shader keeps using its previous program.
+class ShaderWatcher
+{
+private:
+
+	struct watchedShader
+	{
+		Shader*							shader;
+		std::string						path;
+		std::string						directory;
+		std::string						fileName;
+		std::filesystem::file_time_type	lastWrite;
+	};
+
+	struct shaderReload
+	{
+		Shader*				shader;
+		shaderProgSource	source;
+	};
+
+	std::thread m_Thread;
+	std::atomic<bool> m_bRunning;
+
+	// Guards everything below, shared between the worker and render threads
+	std::mutex m_Mutex;
+
+	std::vector<watchedShader> m_vWatched;
+	std::vector<shaderReload> m_vReloads;
+
+#ifdef __linux__
+	int m_iNotify;
+
+	// inotify watch descriptor for each watched directory
+	std::vector<std::pair<int, std::string>> m_vDirectories;
+#endif
+
+	void Run();
+
+	// Worker thread, reparses the file and queues the result for every shader using it
+	void FileChanged(const std::string& directory, const std::string& fileName);
+
+public:
+
+	ShaderWatcher();
+	~ShaderWatcher();
+
+	void Watch(Shader& shader);
+
+	// Also reload the shader from another file, for a program shared by every file with the same source.
+	// Whichever of its files changed last is what the shader is built from.
+	void Watch(Shader& shader, const std::string& filePath);
+
+	// Stops watching every file of the shader
+	void Unwatch(Shader& shader);
+
+	// Call on the GL thread between frames, returns the number of programs that were replaced
+	unsigned int ApplyChanges();
+};
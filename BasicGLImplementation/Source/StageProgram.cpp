@@ -0,0 +1,90 @@
+#include "StageProgram.h"
+
+#include <iostream>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+StageProgram::StageProgram(const std::string& name, const shaderProgSource& source, ShaderStage stage, const std::string& prelude)
+	: m_RendererID(0), m_Stage(stage)
+{
+	if (!source.HasStage(stage))
+	{
+		std::cout << name << " has no " << GetShaderStageName(stage) << " stage" << std::endl;
+		return;
+	}
+
+	// Before 4.1 separable programs come from the extension, which a 330 shader has to enable
+	std::string stagePrelude = GLEW_VERSION_4_1 ? prelude : "#extension GL_ARB_separate_shader_objects : enable\n" + prelude;
+
+	unsigned int shaderId = CompileShaderStage(stage, source.GetStage(stage), stagePrelude);
+
+	// Create a program for just this stage and mark it separable so it can be used in a pipeline
+	unsigned int programId = glCreateProgram();
+	GLCall(glProgramParameteri(programId, GL_PROGRAM_SEPARABLE, GL_TRUE));
+
+	GLCall(glAttachShader(programId, shaderId));
+	GLCall(glLinkProgram(programId));
+
+	bool compiled = CheckShaderStageCompiled(shaderId, stage, name);
+
+	// The program keeps the compiled code so the shader object isn't needed after linking
+	GLCall(glDetachShader(programId, shaderId));
+	GLCall(glDeleteShader(shaderId));
+
+	int program_linked;
+	GLCall(glGetProgramiv(programId, GL_LINK_STATUS, &program_linked));
+
+	if (!compiled || program_linked != GL_TRUE)
+	{
+		GLsizei log_length = 0;
+		GLchar message[1024] = "";
+		GLCall(glGetProgramInfoLog(programId, 1024, &log_length, message));
+
+		std::cout << "Failed to link " << GetShaderStageName(stage) << " stage program " << name << ", message: " << message << std::endl;
+
+		GLCall(glDeleteProgram(programId));
+		return;
+	}
+
+	m_RendererID = programId;
+	m_UniformCache.Build(m_RendererID);
+}
+
+StageProgram::~StageProgram()
+{
+	GLCall(glDeleteProgram(m_RendererID));
+}
+
+void StageProgram::SetUniform1f(UniformId uniform, float v)
+{
+	float values[1] = { v };
+
+	SetUniformValue(m_UniformCache.Find(uniform), 1, values);
+}
+
+void StageProgram::SetUniform4f(UniformId uniform, float v1, float v2, float v3, float v4)
+{
+	float values[4] = { v1, v2, v3, v4 };
+
+	SetUniformValue(m_UniformCache.Find(uniform), 4, values);
+}
+
+void StageProgram::SetUniformMat4f(UniformId uniform, const float* matrix)
+{
+	SetUniformValue(m_UniformCache.Find(uniform), 16, matrix);
+}
+
+void StageProgram::SetUniformValue(const uniformInfo* uniform, unsigned int components, const float* values)
+{
+	if (!uniform || !m_UniformCache.Update(*uniform, values, components * sizeof(float)))
+		return;
+
+	switch (components)
+	{
+	case 1:		GLCall(glProgramUniform1fv(m_RendererID, uniform->location, 1, values)); break;
+	case 4:		GLCall(glProgramUniform4fv(m_RendererID, uniform->location, 1, values)); break;
+	case 16:	GLCall(glProgramUniformMatrix4fv(m_RendererID, uniform->location, 1, GL_FALSE, values)); break;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "ShaderSource.h"
+#include "UniformCache.h"
+
+// A separable program holding a single shader stage (ARB_separate_shader_objects).
+// Stage programs are linked on their own and combined into a ProgramPipeline, so a vertex stage shared by many
+// materials is compiled and linked once instead of once per vertex/fragment combination.
+// Vertex stages for a core profile have to redeclare gl_PerVertex ("out gl_PerVertex { vec4 gl_Position; };").
+class StageProgram
+{
+private:
+
+	unsigned int m_RendererID;
+	ShaderStage m_Stage;
+
+	UniformCache m_UniformCache;
+
+	void SetUniformValue(const uniformInfo* uniform, unsigned int components, const float* values);
+
+public:
+
+	// Compile and link one stage of a parsed shader file, with the prelude injected after #version
+	StageProgram(const std::string& name, const shaderProgSource& source, ShaderStage stage, const std::string& prelude);
+	~StageProgram();
+
+	StageProgram(const StageProgram&) = delete;
+	StageProgram& operator=(const StageProgram&) = delete;
+
+	// Uniforms are set with glProgramUniform* so the program doesn't need to be bound, unchanged values are skipped
+	void SetUniform1f(UniformId uniform, float v);
+	void SetUniform4f(UniformId uniform, float v1, float v2, float v3, float v4);
+	void SetUniformMat4f(UniformId uniform, const float* matrix);
+
+	inline bool IsValid() const { return m_RendererID != 0; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline ShaderStage GetStage() const { return m_Stage; }
+};
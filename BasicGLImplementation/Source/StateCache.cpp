@@ -0,0 +1,214 @@
+#include "StateCache.h"
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+unsigned int StateCache::s_Program = StateCache::Unknown;
+unsigned int StateCache::s_VertexArray = StateCache::Unknown;
+unsigned int StateCache::s_ArrayBuffer = StateCache::Unknown;
+
+std::unordered_map<unsigned int, unsigned int> StateCache::s_ElementBuffers;
+
+unsigned int StateCache::s_ActiveTextureUnit = StateCache::Unknown;
+std::pair<unsigned int, unsigned int> StateCache::s_Textures[StateCache::TextureUnitCount];
+
+std::vector<std::pair<unsigned int, bool>> StateCache::s_vCaps;
+
+unsigned int StateCache::s_iIssued = 0;
+unsigned int StateCache::s_iElided = 0;
+unsigned int StateCache::s_iFrameIssued = 0;
+unsigned int StateCache::s_iFrameElided = 0;
+
+void StateCache::UseProgram(unsigned int program)
+{
+	if (Changes(s_Program, program))
+	{
+		GLCall(glUseProgram(program));
+	}
+}
+
+void StateCache::BindVertexArray(unsigned int vertexArray)
+{
+	if (Changes(s_VertexArray, vertexArray))
+	{
+		GLCall(glBindVertexArray(vertexArray));
+	}
+}
+
+void StateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	if (target == GL_ARRAY_BUFFER)
+	{
+		if (Changes(s_ArrayBuffer, buffer))
+		{
+			GLCall(glBindBuffer(target, buffer));
+		}
+	}
+	else if (target == GL_ELEMENT_ARRAY_BUFFER && s_VertexArray != Unknown)
+	{
+		// Inserts Unknown the first time a vertex array is seen
+		auto elementBuffer = s_ElementBuffers.try_emplace(s_VertexArray, Unknown).first;
+
+		if (Changes(elementBuffer->second, buffer))
+		{
+			GLCall(glBindBuffer(target, buffer));
+		}
+	}
+	else
+	{
+		// Binding an element buffer with no known vertex array changes whichever one is really bound
+		if (target == GL_ELEMENT_ARRAY_BUFFER)
+			s_ElementBuffers.clear();
+
+		s_iIssued++;
+		GLCall(glBindBuffer(target, buffer));
+	}
+}
+
+void StateCache::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+	if (unit >= TextureUnitCount)
+	{
+		s_ActiveTextureUnit = Unknown;
+		s_iIssued += 2;
+
+		GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+		GLCall(glBindTexture(target, texture));
+		return;
+	}
+
+	std::pair<unsigned int, unsigned int>& bound = s_Textures[unit];
+
+	// Only the active unit has to change when the texture is already there
+	if (bound.first == target && bound.second == texture)
+	{
+		s_iElided++;
+		return;
+	}
+
+	if (Changes(s_ActiveTextureUnit, unit))
+	{
+		GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+	}
+
+	bound = { target, texture };
+	s_iIssued++;
+
+	GLCall(glBindTexture(target, texture));
+}
+
+void StateCache::Enable(unsigned int cap)
+{
+	for (auto& state : s_vCaps)
+	{
+		if (state.first != cap)
+			continue;
+
+		if (state.second)
+		{
+			s_iElided++;
+			return;
+		}
+
+		state.second = true;
+		s_iIssued++;
+
+		GLCall(glEnable(cap));
+		return;
+	}
+
+	s_vCaps.push_back({ cap, true });
+	s_iIssued++;
+
+	GLCall(glEnable(cap));
+}
+
+void StateCache::Disable(unsigned int cap)
+{
+	for (auto& state : s_vCaps)
+	{
+		if (state.first != cap)
+			continue;
+
+		if (!state.second)
+		{
+			s_iElided++;
+			return;
+		}
+
+		state.second = false;
+		s_iIssued++;
+
+		GLCall(glDisable(cap));
+		return;
+	}
+
+	s_vCaps.push_back({ cap, false });
+	s_iIssued++;
+
+	GLCall(glDisable(cap));
+}
+
+void StateCache::Invalidate()
+{
+	s_Program = Unknown;
+	s_VertexArray = Unknown;
+	s_ArrayBuffer = Unknown;
+	s_ElementBuffers.clear();
+
+	s_ActiveTextureUnit = Unknown;
+
+	for (auto& texture : s_Textures)
+		texture = { Unknown, Unknown };
+
+	s_vCaps.clear();
+}
+
+void StateCache::OnProgramDeleted(unsigned int program)
+{
+	// A program deleted while in use stays in use until something else is, so the binding isn't 0 but it is stale.
+	// If the name is then reused (eg by a hot reload's new program) binding it has to go to the driver.
+	if (s_Program == program)
+		s_Program = Unknown;
+}
+
+void StateCache::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+	if (s_VertexArray == vertexArray)
+		s_VertexArray = 0;
+
+	s_ElementBuffers.erase(vertexArray);
+}
+
+void StateCache::OnBufferDeleted(unsigned int buffer)
+{
+	if (s_ArrayBuffer == buffer)
+		s_ArrayBuffer = 0;
+
+	// Vertex arrays that aren't bound keep the deleted buffer attached while its name can be handed out again,
+	// so forget the binding instead of assuming 0
+	for (auto& elementBuffer : s_ElementBuffers)
+	{
+		if (elementBuffer.second == buffer)
+			elementBuffer.second = Unknown;
+	}
+}
+
+void StateCache::OnTextureDeleted(unsigned int texture)
+{
+	for (auto& bound : s_Textures)
+	{
+		if (bound.second == texture)
+			bound.second = 0;
+	}
+}
+
+void StateCache::EndFrame()
+{
+	s_iFrameIssued = s_iIssued;
+	s_iFrameElided = s_iElided;
+
+	s_iIssued = 0;
+	s_iElided = 0;
+}
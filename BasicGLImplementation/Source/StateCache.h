@@ -0,0 +1,85 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Shadows the GL binding state of the current context so binding something that is already bound costs nothing.
+// Every bind of a program, vertex array, array/element buffer or texture and every glEnable/glDisable of a cap has to
+// go through here (or be followed by Invalidate), otherwise the shadow no longer matches the driver.
+// Objects have to be reported when they are deleted because GL reuses the names of deleted objects.
+class StateCache
+{
+public:
+
+	// A binding that doesn't match any name, set when the real state isn't known
+	static constexpr unsigned int Unknown = 0xFFFFFFFF;
+
+private:
+
+	static constexpr unsigned int TextureUnitCount = 32;
+
+	static unsigned int s_Program;
+	static unsigned int s_VertexArray;
+	static unsigned int s_ArrayBuffer;
+
+	// The element buffer binding is part of the vertex array object, so it is remembered per vertex array
+	static std::unordered_map<unsigned int, unsigned int> s_ElementBuffers;
+
+	static unsigned int s_ActiveTextureUnit;
+	static std::pair<unsigned int, unsigned int> s_Textures[TextureUnitCount];	// target and name per unit
+
+	static std::vector<std::pair<unsigned int, bool>> s_vCaps;
+
+	static unsigned int s_iIssued;
+	static unsigned int s_iElided;
+	static unsigned int s_iFrameIssued;
+	static unsigned int s_iFrameElided;
+
+	// Counts the call and returns whether it has to go to the driver
+	static inline bool Changes(unsigned int& shadow, unsigned int value)
+	{
+		if (shadow == value)
+		{
+			s_iElided++;
+			return false;
+		}
+
+		shadow = value;
+		s_iIssued++;
+		return true;
+	}
+
+public:
+
+	static void UseProgram(unsigned int program);
+
+	// The program the cache believes is in use, Unknown after Invalidate
+	static inline unsigned int GetProgram() { return s_Program; }
+
+	static void BindVertexArray(unsigned int vertexArray);
+
+	// Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are shadowed, other targets go straight to the driver
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+
+	static void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+
+	static void Enable(unsigned int cap);
+	static void Disable(unsigned int cap);
+
+	// Forget everything, for after GL code that doesn't go through the cache
+	static void Invalidate();
+
+	// GL reverts the bindings of a deleted object to 0 and is free to hand its name out again
+	static void OnProgramDeleted(unsigned int program);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnBufferDeleted(unsigned int buffer);
+	static void OnTextureDeleted(unsigned int texture);
+
+	// Once a frame, makes the counts of the frame that just ended available
+	static void EndFrame();
+
+	// Binds and enables sent to the driver and skipped as redundant during the last frame
+	static inline unsigned int GetFrameIssued() { return s_iFrameIssued; }
+	static inline unsigned int GetFrameElided() { return s_iFrameElided; }
+};
@@ -0,0 +1,130 @@
+#include "StreamingVertexBuffer.h"
+
+#include <iostream>
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+#include "StateCache.h"
+#include "FrameContext.h"
+
+StreamingVertexBuffer::StreamingVertexBuffer(const FrameContext& frameContext, unsigned int bytesPerFrame)
+    : m_FrameContext(frameContext), m_RendererId(0), m_iRegionSize(0), m_iRegionCount(frameContext.GetFramesInFlight()),
+      m_pMapped(nullptr), m_iFrameNumber(~0ull), m_iRegionStart(0), m_iCursor(0), m_iFlushed(0),
+      m_iFailedAllocations(0)
+{
+    // Keep every region start 256 byte aligned, enough for any vertex format or a uniform buffer offset
+    m_iRegionSize = (bytesPerFrame + 255) & ~255u;
+
+    unsigned int totalSize = m_iRegionSize * m_iRegionCount;
+
+    GLCall(glGenBuffers(1, &m_RendererId));
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererId);
+
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {
+        // Coherent so writes are seen by the GPU without explicit flushes, the fences make sure they don't race its reads
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        GLCall(glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags));
+        GLCall(m_pMapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags));
+
+        if (!m_pMapped)
+            std::cout << "Failed to map streaming vertex buffer " << m_RendererId << ", staging in memory instead" << std::endl;
+    }
+
+    if (!m_pMapped)
+    {
+        // Buffer storage is immutable so a failed mapping needs a new buffer
+        if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+        {
+            StateCache::OnBufferDeleted(m_RendererId);
+            GLCall(glDeleteBuffers(1, &m_RendererId));
+            GLCall(glGenBuffers(1, &m_RendererId));
+            StateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererId);
+        }
+
+        GLCall(glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW));
+        m_vStaging.resize(totalSize);
+    }
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+    if (m_pMapped)
+    {
+        StateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererId);
+        GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+    }
+
+    StateCache::OnBufferDeleted(m_RendererId);
+    GLCall(glDeleteBuffers(1, &m_RendererId));
+}
+
+void StreamingVertexBuffer::SyncFrame()
+{
+    // The slot only changes in BeginFrame, and the frame number in EndFrame, so outside a frame the pair doesn't
+    // describe a region the fence covers
+    if (!m_FrameContext.IsInFrame() || m_FrameContext.GetFrameNumber() == m_iFrameNumber)
+        return;
+
+    // A new frame, its slot's fence has already been waited on by FrameContext::BeginFrame so the whole region is free
+    m_iFrameNumber = m_FrameContext.GetFrameNumber();
+    m_iRegionStart = (m_FrameContext.GetFrameSlot() % m_iRegionCount) * m_iRegionSize;
+    m_iCursor = m_iRegionStart;
+    m_iFlushed = m_iRegionStart;
+}
+
+streamAllocation StreamingVertexBuffer::Allocate(unsigned int bytes, unsigned int alignment)
+{
+    if (!m_FrameContext.IsInFrame())
+    {
+        if (m_iFailedAllocations++ == 0)
+            std::cout << "Streaming vertex buffer " << m_RendererId << " allocated from outside a frame, the GPU may still be reading that region" << std::endl;
+
+        return { nullptr, 0 };
+    }
+
+    SyncFrame();
+
+    // Aligned from the start of the buffer rather than the region so offset / stride is a whole vertex
+    unsigned int offset = alignment > 1 ? (m_iCursor + alignment - 1) / alignment * alignment : m_iCursor;
+
+    if (offset + bytes > m_iRegionStart + m_iRegionSize)
+    {
+        if (m_iFailedAllocations++ == 0)
+            std::cout << "Streaming vertex buffer " << m_RendererId << " is out of space, " << m_iRegionSize << " bytes per frame isn't enough" << std::endl;
+
+        return { nullptr, 0 };
+    }
+
+    m_iCursor = offset + bytes;
+
+    char* base = m_pMapped ? m_pMapped : m_vStaging.data();
+
+    return { base + offset, offset };
+}
+
+void StreamingVertexBuffer::Flush()
+{
+    SyncFrame();
+
+    if (m_pMapped || m_iCursor == m_iFlushed)
+        return;
+
+    // The region isn't in use by the GPU so this doesn't wait for anything
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererId);
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, m_iFlushed, m_iCursor - m_iFlushed, m_vStaging.data() + m_iFlushed));
+
+    m_iFlushed = m_iCursor;
+}
+
+void StreamingVertexBuffer::Bind() const
+{
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererId);
+}
+
+void StreamingVertexBuffer::UnBind() const
+{
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
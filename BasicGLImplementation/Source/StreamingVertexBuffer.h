@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+class FrameContext;
+
+// Space handed out by StreamingVertexBuffer::Allocate. The pointer is only valid until the end of the frame,
+// offset is from the start of the GL buffer and is what attribute pointers or a base vertex are worked out from.
+struct streamAllocation
+{
+	void*			pointer;
+	unsigned int	offset;
+};
+
+// A vertex buffer for geometry that is rebuilt every frame. The buffer is split into one region per frame in flight
+// and each frame writes straight into its own region through a persistent, coherent mapping, so there are no
+// glBufferData/glBufferSubData copies and no implicit stalls. A region is only reused once the FrameContext has waited
+// for the fence of the frame that last used it.
+// Persistent mapping needs GL 4.4 or ARB_buffer_storage, without it allocations are staged in memory and uploaded by Flush.
+class StreamingVertexBuffer
+{
+private:
+
+	const FrameContext& m_FrameContext;
+
+	unsigned int m_RendererId;
+
+	unsigned int m_iRegionSize;
+	unsigned int m_iRegionCount;
+
+	// The persistent mapping of the whole buffer, nullptr when staging
+	char* m_pMapped;
+
+	// Used in place of the mapping when persistent mapping isn't supported
+	std::vector<char> m_vStaging;
+
+	// Frame the region was last allocated from, allocations start again at the region start when this changes
+	unsigned long long m_iFrameNumber;
+	unsigned int m_iRegionStart;
+	unsigned int m_iCursor;
+	unsigned int m_iFlushed;
+
+	unsigned int m_iFailedAllocations;
+
+	void SyncFrame();
+
+public:
+
+	// bytesPerFrame is the most that can be allocated in one frame, the buffer is that times the frames in flight
+	StreamingVertexBuffer(const FrameContext& frameContext, unsigned int bytesPerFrame);
+	~StreamingVertexBuffer();
+
+	StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+	StreamingVertexBuffer& operator=(const StreamingVertexBuffer&) = delete;
+
+	// Space for this frame's geometry, pointer is nullptr if the frame's region is full.
+	// Only allocate between FrameContext::BeginFrame and EndFrame, before BeginFrame the GPU may still be reading the
+	// region, allocations made outside a frame fail.
+	// Pass the vertex stride as the alignment to be able to draw the data with a base vertex of offset / stride.
+	streamAllocation Allocate(unsigned int bytes, unsigned int alignment = 4);
+
+	// Upload what has been written since the last Flush, only does anything when staging. Call before drawing.
+	void Flush();
+
+	void Bind() const;
+	void UnBind() const;
+
+	inline unsigned int GetRendererId() const { return m_RendererId; }
+	inline bool IsPersistent() const { return m_pMapped != nullptr; }
+
+	// Bytes allocated so far this frame
+	inline unsigned int GetFrameBytes() const { return m_iCursor - m_iRegionStart; }
+	inline unsigned int GetFailedAllocations() const { return m_iFailedAllocations; }
+};
@@ -0,0 +1,33 @@
+#include "UniformBuffer.h"
+
+#include "GL/glew.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding)
+    : m_iSize(size), m_iBinding(binding)
+{
+    // Create the buffer with storage for the whole block but no data yet, it is filled by SetData every frame
+    GLCall(glGenBuffers(1, &m_RendererId));
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererId));
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+
+    // Attach it to its binding point, any shader block linked to the binding point now reads from this buffer
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, m_iBinding, m_RendererId));
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLCall(glDeleteBuffers(1, &m_RendererId));
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    ASSERT(offset + size <= m_iSize);
+
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererId));
+    GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+}
+
+void UniformBuffer::Bind() const
+{
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, m_iBinding, m_RendererId));
+}
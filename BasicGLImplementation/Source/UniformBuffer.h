@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "Renderer.h"
+
+// Types with the alignment the std140 layout rules give them, for building C++ structs that match a GLSL uniform block.
+// Scalars (float, int) need nothing special. A vec3 is padded to 16 bytes here whereas std140 lets a scalar follow it
+// at offset 12, so check every member with STD140_OFFSET rather than trusting the types alone.
+namespace std140
+{
+	struct alignas(8) vec2 { float x, y; };
+	struct alignas(16) vec3 { float x, y, z; };
+	struct alignas(16) vec4 { float x, y, z, w; };
+
+	// Matrices are stored as arrays of column vectors, every column padded to a vec4
+	struct alignas(16) mat3 { vec4 columns[3]; };
+	struct alignas(16) mat4 { vec4 columns[4]; };
+
+	// Every element of an array is padded to 16 bytes, even float[] and int[]
+	template<typename T>
+	struct alignas(16) element { T value; };
+}
+
+// Fails to compile if a member of a block struct isn't at the offset std140 gives it, eg STD140_OFFSET(cameraBlock, viewProjection, 0);
+#define STD140_OFFSET(block, member, offset) static_assert(offsetof(block, member) == (offset), #block "::" #member " is not at std140 offset " #offset)
+
+// A GL uniform buffer attached to a binding point. Shaders link their uniform blocks to the binding point with
+// Shader::BindUniformBlock, so the whole block is uploaded once and shared by every program that uses it.
+class UniformBuffer
+{
+private:
+
+	unsigned int m_RendererId;
+	unsigned int m_iSize;
+	unsigned int m_iBinding;
+
+public:
+
+	UniformBuffer(unsigned int size, unsigned int binding);
+	~UniformBuffer();
+
+	// One glBufferSubData for the whole range
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	// Attach the buffer to its binding point
+	void Bind() const;
+
+	inline unsigned int GetSize() const { return m_iSize; }
+	inline unsigned int GetBinding() const { return m_iBinding; }
+};
+
+// Uniform buffer holding one std140 block struct
+template<typename T>
+class UniformBlock : public UniformBuffer
+{
+	static_assert(std::is_standard_layout<T>::value, "Uniform block structs must be standard layout so member offsets are well defined");
+	static_assert(std::is_trivially_copyable<T>::value, "Uniform block structs are uploaded with a memcpy so must be trivially copyable");
+	static_assert(sizeof(T) % 16 == 0, "std140 rounds a block up to a multiple of 16 bytes, add padding to the end of the struct");
+
+public:
+
+	UniformBlock(unsigned int binding)
+		: UniformBuffer(sizeof(T), binding) {}
+
+	void Upload(const T& block)
+	{
+		SetData(&block, sizeof(T));
+	}
+};
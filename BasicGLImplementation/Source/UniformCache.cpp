@@ -0,0 +1,207 @@
+#include "UniformCache.h"
+
+#include "GL/glew.h"
+
+#include "Renderer.h"
+
+#include <iostream>
+#include <cstring>
+
+// Bytes taken by one element of a uniform of the given type
+static unsigned int GetUniformTypeSize(unsigned int type)
+{
+	switch (type)
+	{
+	case GL_FLOAT:			return 4;
+	case GL_FLOAT_VEC2:		return 8;
+	case GL_FLOAT_VEC3:		return 12;
+	case GL_FLOAT_VEC4:		return 16;
+	case GL_INT:			return 4;
+	case GL_INT_VEC2:		return 8;
+	case GL_INT_VEC3:		return 12;
+	case GL_INT_VEC4:		return 16;
+	case GL_UNSIGNED_INT:	return 4;
+	case GL_BOOL:			return 4;
+	case GL_FLOAT_MAT2:		return 16;
+	case GL_FLOAT_MAT3:		return 36;
+	case GL_FLOAT_MAT4:		return 64;
+	}
+
+	// Samplers and images are set with glUniform1i
+	return 4;
+}
+
+void UniformCache::Build(unsigned int programId)
+{
+	m_vUniforms.clear();
+	m_vBlocks.clear();
+	m_vShadows.clear();
+	m_vShadowValues.clear();
+	m_vSlots.clear();
+	m_iMask = 0;
+
+	int uniformCount = 0;
+	int maxNameLength = 0;
+
+	GLCall(glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &uniformCount));
+	GLCall(glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+
+	std::vector<char> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+
+	for (int i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+
+		GLCall(glGetActiveUniform(programId, i, (GLsizei)nameBuffer.size(), &nameLength, &size, &type, nameBuffer.data()));
+
+		// Uniforms that live in a uniform block have no location and can't be set with glUniform*
+		GLCall(int location = glGetUniformLocation(programId, nameBuffer.data()));
+
+		if (location == -1)
+			continue;
+
+		std::string_view name(nameBuffer.data(), nameLength);
+
+		// Room for every element, nothing is known about the value until it is first set
+		unsigned int shadowIndex = (unsigned int)m_vShadows.size();
+		unsigned int shadowSize = GetUniformTypeSize(type) * size;
+
+		m_vShadows.push_back({ (unsigned int)m_vShadowValues.size(), shadowSize, 0 });
+		m_vShadowValues.resize(m_vShadowValues.size() + shadowSize);
+
+		Insert(name, location, type, size, shadowIndex);
+
+		// Arrays are reported as "name[0]", also allow them to be found using just "name"
+		if (name.size() > 3 && name.substr(name.size() - 3) == "[0]")
+			Insert(name.substr(0, name.size() - 3), location, type, size, shadowIndex);
+	}
+
+	int blockCount = 0;
+	int maxBlockNameLength = 0;
+
+	GLCall(glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+	GLCall(glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength));
+
+	std::vector<char> blockNameBuffer(maxBlockNameLength > 0 ? maxBlockNameLength : 1);
+
+	for (int i = 0; i < blockCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint dataSize = 0;
+
+		GLCall(glGetActiveUniformBlockName(programId, i, (GLsizei)blockNameBuffer.size(), &nameLength, blockNameBuffer.data()));
+		GLCall(glGetActiveUniformBlockiv(programId, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+
+		m_vBlocks.push_back({ std::string(blockNameBuffer.data(), nameLength), (unsigned int)i, dataSize });
+	}
+
+	// Size the slot array to a power of two at least twice the uniform count to keep probe chains short
+	unsigned int capacity = 8;
+
+	while (capacity < m_vUniforms.size() * 2)
+		capacity *= 2;
+
+	m_iMask = capacity - 1;
+	m_vSlots.assign(capacity, -1);
+
+	for (unsigned int i = 0; i < m_vUniforms.size(); i++)
+	{
+		unsigned int slot = m_vUniforms[i].nameHash & m_iMask;
+
+		while (m_vSlots[slot] != -1)
+		{
+			// A UniformId can't tell these two apart, they have to be set by name instead
+			if (m_vUniforms[m_vSlots[slot]].nameHash == m_vUniforms[i].nameHash)
+				std::cout << "Uniforms " << m_vUniforms[m_vSlots[slot]].name << " and " << m_vUniforms[i].name << " have the same name hash" << std::endl;
+
+			slot = (slot + 1) & m_iMask;
+		}
+
+		m_vSlots[slot] = (int)i;
+	}
+}
+
+void UniformCache::Insert(std::string_view name, int location, unsigned int type, int size, unsigned int shadowIndex)
+{
+	m_vUniforms.push_back({ std::string(name), HashUniformName(name), location, type, size, shadowIndex });
+}
+
+bool UniformCache::Update(const uniformInfo& uniform, const void* value, unsigned int size)
+{
+	uniformShadow& shadow = m_vShadows[uniform.shadowIndex];
+	unsigned char* storedValue = m_vShadowValues.data() + shadow.offset;
+
+	// Skip only if every byte being set was uploaded before with the same value
+	if (size <= shadow.knownSize && std::memcmp(storedValue, value, size) == 0)
+	{
+		m_iUploadsSkipped++;
+		return false;
+	}
+
+	// A value bigger than the uniform can't be shadowed, let it through and GL reports the error
+	if (size <= shadow.size)
+	{
+		std::memcpy(storedValue, value, size);
+
+		if (size > shadow.knownSize)
+			shadow.knownSize = size;
+	}
+
+	m_iUploadsIssued++;
+	return true;
+}
+
+const uniformInfo* UniformCache::Find(std::string_view name) const
+{
+	if (m_vSlots.empty())
+		return nullptr;
+
+	unsigned int hash = HashUniformName(name);
+	unsigned int slot = hash & m_iMask;
+
+	// Linear probe until the name is found or an empty slot ends the chain
+	while (m_vSlots[slot] != -1)
+	{
+		const uniformInfo& uniform = m_vUniforms[m_vSlots[slot]];
+
+		if (uniform.nameHash == hash && uniform.name == name)
+			return &uniform;
+
+		slot = (slot + 1) & m_iMask;
+	}
+
+	return nullptr;
+}
+
+const uniformInfo* UniformCache::Find(UniformId id) const
+{
+	if (m_vSlots.empty())
+		return nullptr;
+
+	unsigned int slot = id.hash & m_iMask;
+
+	while (m_vSlots[slot] != -1)
+	{
+		const uniformInfo& uniform = m_vUniforms[m_vSlots[slot]];
+
+		if (uniform.nameHash == id.hash)
+			return &uniform;
+
+		slot = (slot + 1) & m_iMask;
+	}
+
+	return nullptr;
+}
+
+const uniformBlockInfo* UniformCache::FindBlock(std::string_view name) const
+{
+	for (const uniformBlockInfo& block : m_vBlocks)
+	{
+		if (block.name == name)
+			return &block;
+	}
+
+	return nullptr;
+}
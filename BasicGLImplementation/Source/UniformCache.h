@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// FNV-1a hash of a uniform name, used as the key of the uniform cache
+constexpr unsigned int HashUniformName(std::string_view name)
+{
+	unsigned int hash = 2166136261u;
+
+	for (char c : name)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// Uniform name hashed at compile time, eg "u_Colour"_uniform.
+// Setting a uniform through one of these needs no string construction or comparison.
+struct UniformId
+{
+	unsigned int	hash;
+	const char*		name;	// Kept only for error messages
+
+	constexpr UniformId(const char* uniformName, std::size_t length)
+		:hash(HashUniformName(std::string_view(uniformName, length))), name(uniformName) {}
+};
+
+constexpr UniformId operator""_uniform(const char* uniformName, std::size_t length)
+{
+	return UniformId(uniformName, length);
+}
+
+// Details of one active uniform, read back from the program once it has been linked
+struct uniformInfo
+{
+	std::string		name;
+	unsigned int	nameHash;
+	int				location;
+	unsigned int	type;
+	int				size;
+	unsigned int	shadowIndex;	// Shared by the "name" and "name[0]" entries of an array
+};
+
+// Details of one active uniform block
+struct uniformBlockInfo
+{
+	std::string		name;
+	unsigned int	index;
+	int				dataSize;
+};
+
+// Flat open addressing hash table of the active uniforms of a program.
+// Built once after linking so setting a uniform never has to ask the driver for its location.
+class UniformCache
+{
+private:
+
+	// Copy of the value last uploaded to a uniform, so setting the same value again can skip the GL call
+	struct uniformShadow
+	{
+		unsigned int offset;
+		unsigned int size;
+		unsigned int knownSize;	// How many bytes from the start of the value have been uploaded so far
+	};
+
+	std::vector<uniformInfo> m_vUniforms;
+
+	std::vector<uniformShadow> m_vShadows;
+	std::vector<unsigned char> m_vShadowValues;
+
+	unsigned int m_iUploadsIssued;
+	unsigned int m_iUploadsSkipped;
+
+	// Programs only have a handful of blocks so these are searched in order
+	std::vector<uniformBlockInfo> m_vBlocks;
+
+	// Each slot holds an index into m_vUniforms, or -1 if the slot is empty
+	std::vector<int> m_vSlots;
+
+	unsigned int m_iMask;
+
+	void Insert(std::string_view name, int location, unsigned int type, int size, unsigned int shadowIndex);
+
+public:
+
+	UniformCache()
+		:m_iUploadsIssued(0), m_iUploadsSkipped(0), m_iMask(0) {}
+
+	// Enumerate the active uniforms of a linked program and fill the table
+	void Build(unsigned int programId);
+
+	// Returns nullptr if the program has no active uniform with this name
+	const uniformInfo* Find(std::string_view name) const;
+
+	// Hash only lookup, names that collide are reported when the table is built
+	const uniformInfo* Find(UniformId id) const;
+
+	// Compare the value with the one last uploaded and remember it, returns false if the upload can be skipped
+	bool Update(const uniformInfo& uniform, const void* value, unsigned int size);
+
+	inline unsigned int GetUploadsIssued() const { return m_iUploadsIssued; }
+	inline unsigned int GetUploadsSkipped() const { return m_iUploadsSkipped; }
+
+	// Returns nullptr if the program has no active uniform block with this name
+	const uniformBlockInfo* FindBlock(std::string_view name) const;
+
+	inline const std::vector<uniformInfo>& GetUniforms() const { return m_vUniforms; }
+	inline const std::vector<uniformBlockInfo>& GetBlocks() const { return m_vBlocks; }
+};
@@ -0,0 +1,101 @@
+#include "UniformValues.h"
+
+#include <cstring>
+
+#include "Shader.h"
+
+void uniformValue::Set1f(float v)
+{
+	type = valueType::Float1;
+	values[0] = v;
+}
+
+void uniformValue::Set4f(float v1, float v2, float v3, float v4)
+{
+	type = valueType::Float4;
+	values[0] = v1;
+	values[1] = v2;
+	values[2] = v3;
+	values[3] = v4;
+}
+
+void uniformValue::Set1i(int v)
+{
+	type = valueType::Int1;
+	intValue = v;
+}
+
+void uniformValue::SetMat4f(const float* matrix)
+{
+	type = valueType::Mat4;
+	std::memcpy(values, matrix, sizeof(float) * 16);
+}
+
+void uniformValue::Apply(Shader& shader) const
+{
+	switch (type)
+	{
+	case valueType::Float1:	shader.SetUniform1f(uniform, values[0]); break;
+	case valueType::Float4:	shader.SetUniform4f(uniform, values[0], values[1], values[2], values[3]); break;
+	case valueType::Int1:	shader.SetUniform1i(uniform, intValue); break;
+	case valueType::Mat4:	shader.SetUniformMat4f(uniform, values); break;
+	}
+}
+
+UniformValues::UniformValues(Arena& arena)
+	: m_pArena(&arena), m_pFirst(nullptr), m_pLast(nullptr)
+{
+}
+
+uniformValue* UniformValues::Get(UniformId uniform)
+{
+	// Only a handful of uniforms are set per draw or material, a walk down the list is cheaper than a map
+	for (valueNode* node = m_pFirst; node; node = node->next)
+	{
+		if (node->value.uniform.hash == uniform.hash)
+			return &node->value;
+	}
+
+	// UniformId has no default constructor so the value is built in place, the setter fills in the type
+	valueNode* node = new (m_pArena->Allocate(sizeof(valueNode), alignof(valueNode))) valueNode{ nullptr, { uniform, uniformValue::valueType::Float1, {}, 0 } };
+
+	if (m_pLast)
+		m_pLast->next = node;
+	else
+		m_pFirst = node;
+
+	m_pLast = node;
+
+	return &node->value;
+}
+
+UniformValues& UniformValues::SetUniform1f(UniformId uniform, float v)
+{
+	Get(uniform)->Set1f(v);
+	return *this;
+}
+
+UniformValues& UniformValues::SetUniform4f(UniformId uniform, float v1, float v2, float v3, float v4)
+{
+	Get(uniform)->Set4f(v1, v2, v3, v4);
+	return *this;
+}
+
+UniformValues& UniformValues::SetUniform1i(UniformId uniform, int v)
+{
+	Get(uniform)->Set1i(v);
+	return *this;
+}
+
+UniformValues& UniformValues::SetUniformMat4f(UniformId uniform, const float* matrix)
+{
+	Get(uniform)->SetMat4f(matrix);
+	return *this;
+}
+
+void UniformValues::Apply(Shader& shader) const
+{
+	// The shader's uniform cache skips any value the program already has, eg the same material twice in a row
+	for (const valueNode* node = m_pFirst; node; node = node->next)
+		node->value.Apply(shader);
+}
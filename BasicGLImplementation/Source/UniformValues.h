@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Arena.h"
+#include "UniformCache.h"
+
+class Shader;
+
+// One uniform value recorded to be set on a shader later, shared by UniformValues and CommandList's uniform commands
+struct uniformValue
+{
+	enum class valueType : unsigned char
+	{
+		Float1,
+		Float4,
+		Int1,
+		Mat4
+	};
+
+	UniformId		uniform;
+	valueType		type;
+	float			values[16];
+	int				intValue;
+
+	// Each records the value and its type, replacing whatever was recorded before
+	void Set1f(float v);
+	void Set4f(float v1, float v2, float v3, float v4);
+	void Set1i(int v);
+	void SetMat4f(const float* matrix);
+
+	// Set the recorded value on the shader, which must be bound
+	void Apply(Shader& shader) const;
+};
+
+// Uniform values recorded into an arena and set on a shader later, used for the per draw and per material values
+// of draws queued with Renderer::Submit. Setting a uniform again overwrites its value rather than recording another,
+// so a material whose values are set every frame doesn't keep growing its arena.
+class UniformValues
+{
+private:
+
+	struct valueNode
+	{
+		valueNode*		next;
+		uniformValue	value;
+	};
+
+	Arena* m_pArena;
+
+	valueNode* m_pFirst;
+	valueNode* m_pLast;
+
+	// The value already recorded for the uniform, or a new one appended to the list
+	uniformValue* Get(UniformId uniform);
+
+public:
+
+	// The arena holds the values and must outlive them
+	UniformValues(Arena& arena);
+
+	UniformValues& SetUniform1f(UniformId uniform, float v);
+	UniformValues& SetUniform4f(UniformId uniform, float v1, float v2, float v3, float v4);
+	UniformValues& SetUniform1i(UniformId uniform, int v);
+	UniformValues& SetUniformMat4f(UniformId uniform, const float* matrix);
+
+	// Set every value on the shader in the order the uniforms were first set, the shader must be bound
+	void Apply(Shader& shader) const;
+
+	inline bool IsEmpty() const { return m_pFirst == nullptr; }
+};
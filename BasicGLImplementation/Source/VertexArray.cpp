@@ -1,5 +1,8 @@
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "Shader.h"
+#include "StateCache.h"
+#include "StreamingVertexBuffer.h"
 
 VertexArray::VertexArray()
 {
@@ -8,6 +11,7 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
+	StateCache::OnVertexArrayDeleted(m_iRendererID);
 	GLCall(glDeleteVertexArrays(1, &m_iRendererID));
 }
 
@@ -16,6 +20,30 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	Bind();
 	vb.Bind();
 
+	SetLayout(layout, nullptr);
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, Shader& shader)
+{
+	// Report any mismatch once now rather than as GL errors on every draw
+	shader.IsCompatible(layout);
+
+	Bind();
+	vb.Bind();
+
+	SetLayout(layout, &shader);
+}
+
+void VertexArray::AddBuffer(const StreamingVertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	Bind();
+	vb.Bind();
+
+	SetLayout(layout, nullptr);
+}
+
+void VertexArray::SetLayout(const VertexBufferLayout& layout, const Shader* shader)
+{
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 
@@ -23,24 +51,40 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	{
 		const auto& element = elements[i];
 
+		const void* elementOffset = (const void*)(size_t)offset;
+		offset += element.count * VertexBufferElement::GetTypeSize(element.type);
+
+		// Named elements go to the reflected location of the shader attribute with that name
+		int location = (shader && !element.name.empty()) ? shader->GetAttributeLocation(element.name) : (int)i;
+
+		// The shader doesn't use this attribute (or it was optimised away)
+		if (location == -1)
+			continue;
+
 		// Enable the vertex attribute Array
-		GLCall(glEnableVertexAttribArray(i));
+		GLCall(glEnableVertexAttribArray(location));
 
 		// Set vertex attribute details 
 		// This call links the currently bound vertex buffer (at 0 as per glVertexAttribPointer(0... <-- ) 
 		// and attribute in the vertex array object above. The vertexArrayObject can then be bound and used instead of bind buffer and glVertexAttribPointer
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalised, layout.GetStride(), (const void*)offset));
-
-		offset += element.count * VertexBufferElement::GetTypeSize(element.type);
+		// Integer data for int/uint attributes has to skip the conversion to float or the shader reads the float's bits
+		if (element.IsInteger())
+		{
+			GLCall(glVertexAttribIPointer(location, element.count, element.type, layout.GetStride(), elementOffset));
+		}
+		else
+		{
+			GLCall(glVertexAttribPointer(location, element.count, element.type, element.normalised, layout.GetStride(), elementOffset));
+		}
 	}
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_iRendererID));
+	StateCache::BindVertexArray(m_iRendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	StateCache::BindVertexArray(0);
 }
\ No newline at end of file
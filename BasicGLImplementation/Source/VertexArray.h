@@ -3,17 +3,31 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
+class Shader;
+class StreamingVertexBuffer;
+
 class VertexArray
 {
 private:
 	unsigned int m_iRendererID;
 
+	// Point the attributes at the bound vertex buffer
+	void SetLayout(const VertexBufferLayout& layout, const Shader* shader);
+
 public:
 	VertexArray();
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
+	// Named layout elements are sent to the shader's attribute with that name, and the layout is checked against the shader once here
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, Shader& shader);
+
+	// Attributes start at offset 0, draw each frame's allocation with a base vertex of its offset / stride
+	void AddBuffer(const StreamingVertexBuffer& vb, const VertexBufferLayout& layout);
+
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_iRendererID; }
 };
\ No newline at end of file
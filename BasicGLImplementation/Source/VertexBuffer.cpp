@@ -3,27 +3,57 @@
 #include "GL/glew.h"
 
 #include "Renderer.h"
+#include "StateCache.h"
 
 
+// Generates the buffer id and binds it so the updater can create the storage
+static unsigned int CreateVertexBuffer()
+{
+    unsigned int bufferId;
+
+    GLCall(glGenBuffers(1, &bufferId));
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, bufferId);
+
+    return bufferId;
+}
+
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+    : m_RendererId(CreateVertexBuffer()), m_Updater(GL_ARRAY_BUFFER, data, size)
 {
-    // Create a vertex buffer with the provided id (bufferId) and bind it
-    GLCall(glGenBuffers(1, &m_RendererId));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererId));
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
 VertexBuffer::~VertexBuffer()
 {
+    StateCache::OnBufferDeleted(m_RendererId);
     GLCall(glDeleteBuffers(1, &m_RendererId));
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererId));
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererId);
 }
 
 void VertexBuffer::UnBind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::Replace(const void* data, unsigned int size)
+{
+    m_Updater.Replace(m_RendererId, data, size);
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    m_Updater.Write(m_RendererId, data, size, offset);
+}
+
+void VertexBuffer::UpdateRange(const void* data, unsigned int size, unsigned int offset)
+{
+    m_Updater.UpdateRange(m_RendererId, data, size, offset);
+}
+
+void VertexBuffer::Flush()
+{
+    m_Updater.Flush(m_RendererId);
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "BufferUpdater.h"
+
 class VertexBuffer
 {
 public:
@@ -9,8 +11,29 @@ public:
 	void Bind() const;
 	void UnBind() const;
 
+	// Replace the whole buffer now, the size may change
+	void Replace(const void* data, unsigned int size);
+
+	// Write part of the buffer now, the range must be inside it. Matches the other buffer types so
+	// CommandList::UpdateBuffer can record it.
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	// Change part of the buffer, edits are coalesced and uploaded by the next Flush
+	void UpdateRange(const void* data, unsigned int size, unsigned int offset);
+
+	// Upload the edits made with UpdateRange, call once they are done and before drawing
+	void Flush();
+
+	inline unsigned int GetSize() const { return m_Updater.GetSize(); }
+
+	inline unsigned long long GetBytesUploaded() const { return m_Updater.GetBytesUploaded(); }
+	inline unsigned int GetUploadCalls() const { return m_Updater.GetUploadCalls(); }
+
 private:
 
 	unsigned int m_RendererId;
 
+	// CPU copy of the contents and the ranges changed since the last Flush
+	BufferUpdater m_Updater;
+
 };
\ No newline at end of file
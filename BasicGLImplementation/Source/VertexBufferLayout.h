@@ -2,9 +2,11 @@
 
 #include "GL/glew.h"
 
+#include <string>
 #include <vector>
 
 #include "Renderer.h"
+#include "Hash.h"
 
 
 struct VertexBufferElement
@@ -12,6 +14,7 @@ struct VertexBufferElement
 	unsigned int	type;
 	unsigned int	count;
 	unsigned char	normalised;
+	std::string		name;	// Shader attribute the element feeds, empty to use the element's index as the attribute location
 
 	static unsigned int GetTypeSize(unsigned int type)
 	{
@@ -19,12 +22,18 @@ struct VertexBufferElement
 		{
 		case GL_FLOAT:		return 4;
 		case GL_INT:		return 4;
+		case GL_UNSIGNED_INT:	return 4;
 		case GL_BYTE:		return 1;
+		case GL_UNSIGNED_BYTE:	return 1;
 		}
 
 		ASSERT(false);
 		return 0;
 	}
+
+	// Integer data that isn't normalised is passed to the shader as integers with glVertexAttribIPointer,
+	// so it can only feed int/uint attributes. Everything else is converted to float.
+	inline bool IsInteger() const { return type != GL_FLOAT && !normalised; }
 };
 
 class VertexBufferLayout
@@ -35,40 +44,58 @@ private:
 
 	std::vector<VertexBufferElement> m_vElements;
 
+	// Identifies the layout so shaders can remember which layouts they have already been checked against
+	unsigned long long m_iHash;
+
+	void AddElement(unsigned int type, unsigned int count, unsigned char normalised, const char* name)
+	{
+		m_vElements.push_back({ type, count, normalised, name ? name : "" });
+		m_iStride += count * VertexBufferElement::GetTypeSize(type);
+
+		unsigned int description[3] = { type, count, normalised };
+		m_iHash = HashBytes(std::string_view((const char*)description, sizeof(description)), m_iHash);
+		m_iHash = HashBytes(m_vElements.back().name, HashBytes("|", m_iHash));
+	}
+
 public:
 
 	VertexBufferLayout()
-		:m_iStride(0) {}
+		:m_iStride(0), m_iHash(HashBytes("")) {}
 
 	~VertexBufferLayout();
 
+	// Pass the attribute name to feed that attribute whatever its location is in the shader
 	template<typename T>
-	void Push(unsigned int count)
+	void Push(unsigned int count, const char* name = nullptr)
 	{
 		static_assert(false);
 	}
 
 	template<>
-	void Push<float>(unsigned int count)
+	void Push<float>(unsigned int count, const char* name)
+	{
+		AddElement(GL_FLOAT, count, GL_FALSE, name);
+	}
+
+	template<>
+	void Push<int>(unsigned int count, const char* name)
 	{
-		m_vElements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_iStride += count * VertexBufferElement::GetTypeSize(GL_FLOAT);
+		AddElement(GL_INT, count, GL_FALSE, name);
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count)
+	void Push<unsigned int>(unsigned int count, const char* name)
 	{
-		m_vElements.push_back({ GL_UNSIGNED_INT, count, GL_TRUE });
-		m_iStride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_INT);
+		AddElement(GL_UNSIGNED_INT, count, GL_TRUE, name);
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count)
+	void Push<unsigned char>(unsigned int count, const char* name)
 	{
-		m_vElements.push_back({ GL_UNSIGNED_BYTE, count, GL_FALSE });
-		m_iStride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_BYTE);
+		AddElement(GL_UNSIGNED_BYTE, count, GL_FALSE, name);
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_vElements; }
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_vElements; }
 	inline unsigned int GetStride() const { return m_iStride; }
+	inline unsigned long long GetHash() const { return m_iHash; }
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# Generates Source/Generated/EmbeddedShaders.h, which compiles every Res/Shaders/*.shader file into the executable.
+# Run as a pre-build step of the Release configurations (which define EMBED_SHADERS) so shipped builds read no shader files.
+#
+# usage: EmbedShaders.py <project directory> <output header>
+#
+# The files are only copied here, splitting them into stages is done at compile time by EmbedShader in ShaderSource.h
+# so there is one set of parsing rules. Each file is written out as a char array rather than a string literal because
+# MSVC limits the length of string literals. The header is only rewritten when its contents change so an unchanged
+# set of shaders doesn't trigger a rebuild.
+
+import os
+import sys
+
+SHADER_DIRECTORY = "Res/Shaders"
+BYTES_PER_LINE = 24
+
+
+def embed_file(index, path, data):
+    lines = ["static constexpr char s_EmbeddedShaderText{}[] = {{".format(index)]
+
+    for start in range(0, len(data), BYTES_PER_LINE):
+        lines.append("\t" + ", ".join((str(byte) if byte < 128 else "char({})".format(byte)) for byte in data[start:start + BYTES_PER_LINE]) + ",")
+
+    # An empty file still needs one element, the view below ignores it
+    if not data:
+        lines.append("\t0")
+
+    lines.append("};")
+    lines.append("")
+
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: EmbedShaders.py <project directory> <output header>")
+        return 1
+
+    project_directory = sys.argv[1]
+    output_path = sys.argv[2]
+
+    shader_directory = os.path.join(project_directory, SHADER_DIRECTORY)
+    shader_files = sorted(name for name in os.listdir(shader_directory) if name.endswith(".shader"))
+
+    if not shader_files:
+        print("EmbedShaders: no .shader files in " + shader_directory)
+        return 1
+
+    parts = [
+        "// Generated by Tools/EmbedShaders.py, do not edit",
+        "#pragma once",
+        "",
+        "#include \"../ShaderSource.h\"",
+        "",
+    ]
+
+    entries = []
+
+    for index, name in enumerate(shader_files):
+        # Paths are stored the way the code names them, relative to the project directory with forward slashes
+        path = SHADER_DIRECTORY + "/" + name
+
+        with open(os.path.join(shader_directory, name), "rb") as shader_file:
+            data = shader_file.read()
+
+        parts.append(embed_file(index, path, data))
+        entries.append("\tEmbedShader(\"{}\", std::string_view(s_EmbeddedShaderText{}, {})),".format(path, index, len(data)))
+
+    parts.append("static constexpr embeddedShader s_EmbeddedShaders[] = {")
+    parts.extend(entries)
+    parts.append("};")
+    parts.append("")
+
+    # Stage splitting errors in an embedded shader fail the build rather than the first run
+    for index, name in enumerate(shader_files):
+        parts.append("static_assert(s_EmbeddedShaders[{}].valid, \"{}/{} has #shader errors, load it from the file in a Debug build to see them\");".format(index, SHADER_DIRECTORY, name))
+
+    contents = "\n".join(parts) + "\n"
+
+    if os.path.exists(output_path):
+        with open(output_path, "r", newline="") as existing:
+            if existing.read() == contents:
+                return 0
+
+    os.makedirs(os.path.dirname(output_path), exist_ok=True)
+
+    with open(output_path, "w", newline="") as output:
+        output.write(contents)
+
+    print("EmbedShaders: embedded {} shader file(s) in {}".format(len(shader_files), output_path))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())